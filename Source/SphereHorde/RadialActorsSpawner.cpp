@@ -2,11 +2,50 @@
 
 #include "RadialActorsSpawner.h"
 #include "SphereTarget.h"
+#include "SphereHordeGameMode.h"
+#include "SphereHordeMovingHorde.h"
+#include "SphereHordeReplicatedHorde.h"
+#include "SphereHordeNavSpawnPoints.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/GamePlayStatics.h"
 #include "Components/BoxComponent.h"
 #include "GameFramework/PlayerController.h"
 #include "Components/BrushComponent.h"
+#include "Engine/AssetManager.h"
+#include "Engine/DataTable.h"
+#include "RenderCore.h"
+#include "HAL/IConsoleManager.h"
+
+// the console variables to tune the spawner at runtime, 0 keeps the value of the spawn rules or turns the limit off
+static TAutoConsoleVariable<int32> CVarHordeSpawnMaxAttempts(
+	TEXT("horde.Spawn.MaxAttempts"),
+	1000,
+	TEXT("The number of the attempts to find a position for a target, and to place the targets of a spawn call."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarHordeSpawnActorsPerTick(
+	TEXT("horde.Spawn.ActorsPerTick"),
+	0,
+	TEXT("The number of the next wave actors placed per frame, 0 uses PreparedActorsPerTick of the spawn rules."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarHordePoolMaxSize(
+	TEXT("horde.Pool.MaxSize"),
+	0,
+	TEXT("The max number of the disabled targets kept for reuse, the released targets over it are destroyed, 0 keeps all of them."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarHordeMaxLiveTargets(
+	TEXT("horde.MaxLiveTargets"),
+	0,
+	TEXT("The max number of the live targets the next waves grow to, the in range targets are never cut, 0 turns the cap off."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarHordeVfxMaxPerFrame(
+	TEXT("horde.Vfx.MaxPerFrame"),
+	0,
+	TEXT("The max number of the destruction vfx spawned per frame, 0 turns the cap off."),
+	ECVF_Default);
 
 // the constructor that takes number of actors and number of inner radius actors for creation of spawner object
 ARadialActorsSpawner::ARadialActorsSpawner()
@@ -18,6 +57,49 @@ ARadialActorsSpawner::ARadialActorsSpawner()
 	MaxActorScale = 1.f;
 	CurrentActorScale = MaxActorScale;
 
+	// the growth starts from the number of actors set by the game mode on begin play
+	GrownActorsNb = 0;
+
+	// the first wave is spawned on begin play
+	CurrentWaveId = 1;
+
+	// no wave is spawned yet
+	LastWaveSpawnMs = 0.f;
+
+	// the moving and replicated hordes are spawned on begin play if their classes are set
+	MovingHorde = nullptr;
+	ReplicatedHorde = nullptr;
+
+	// the next wave is not prepared until the game mode asks for it
+	bIsPreparingNextWave = false;
+	PreparedWaveId = CurrentWaveId;
+	PendingInnerActorsNb = 0;
+	PendingOutterActorsNb = 0;
+
+	// the spawn stream is seeded randomly unless the game mode sets the seed
+	SpawnStream.GenerateNewSeed();
+	bDeterministicSpawning = false;
+
+	// the reachable points are cached only if the targets are spawned on the navmesh
+	NavSpawnPoints = nullptr;
+	bIsWaitingForNavSpawnPoints = false;
+	NavSpawnPointsWaitTime = 0.f;
+
+	// the real frame time is measured from the second tick
+	LastTickSeconds = 0.0;
+
+	// the targets are streamed from the first tick if the materialize radius is set
+	StreamingUpdateTime = 0.f;
+
+	// no wave is forced and no vfx is played yet
+	ForcedActorsNb = 0;
+	LimitedActorsNb = 0;
+
+	// the game mode sets the number of the kills per wave on initialize
+	MinInnerRadiusActorsNb = 0;
+	VfxFrameNumber = 0;
+	VfxPlayedInFrameNb = 0;
+
 	// set spawner z offset to 0.f by default
 	zOffset = 0.f;
 
@@ -49,8 +131,14 @@ ARadialActorsSpawner::ARadialActorsSpawner()
 }
 
 // the function to initialize number of actors to spawn
-void ARadialActorsSpawner::Initialize(int32 ActorsNb, int32 InnerRadiusNb)
+void ARadialActorsSpawner::Initialize(int32 ActorsNb, int32 InnerRadiusNb, float InRangeRadius)
 {
+	// set the radius within it the spawned actors are counted as in range
+	SpawnRules.InRangeRadius = InRangeRadius;
+
+	// the scheduled waves keep at least as many in range targets as the kills the game mode waits for
+	MinInnerRadiusActorsNb = InnerRadiusNb;
+
 	// check if number actors to be spawned in the inner radius (10 by default) is less thanthe total number of actors
 	if (ActorsNb < InnerRadiusNb)
 	{
@@ -65,6 +153,12 @@ void ARadialActorsSpawner::Initialize(int32 ActorsNb, int32 InnerRadiusNb)
 	SpawnRules.InnerRadiusActorsNb = InnerRadiusNb;
 }
 
+// get the id of the wave that is currently spawned
+int32	ARadialActorsSpawner::GetCurrentWaveId() const
+{
+	return CurrentWaveId;
+}
+
 // Called when the game starts or when spawned
 void ARadialActorsSpawner::BeginPlay()
 {
@@ -76,6 +170,45 @@ void ARadialActorsSpawner::BeginPlay()
 		return;
 	}
 
+	// spawn the moving horde at the origin, its instances are placed in world space
+	if (MovingHordeClass)
+	{
+		MovingHorde = GetWorld()->SpawnActor<ASphereHordeMovingHorde>(MovingHordeClass, FTransform::Identity);
+		if (MovingHorde)
+		{
+			MovingHorde->SetRandomSeed(SpawnStream.GetInitialSeed());
+		}
+	}
+
+	// the replicated horde is needed only if there are clients to replicate to
+	if (ReplicatedHordeClass && GetNetMode() != NM_Standalone)
+	{
+		ReplicatedHorde = GetWorld()->SpawnActor<ASphereHordeReplicatedHorde>(ReplicatedHordeClass, FTransform::Identity);
+	}
+
+	TargetIndex.Initialize(TargetIndexCellSize);
+	DormantTargets.Initialize(TargetIndexCellSize);
+
+	// the recorded and replayed games are not scaled by the machine they run on, so the replays place the same waves
+	FSphereHordePerfBudget GovernorBudget = PerfBudget;
+	GovernorBudget.bAdaptiveWaveScaling &= !bDeterministicSpawning;
+	PerfGovernor.Initialize(GovernorBudget);
+
+	// the reachable points are looked for in the background from now on, so the first wave may use them
+	if (SpawnRules.SpawnObjectsUnderPawn)
+	{
+		NavSpawnPoints = NewObject<USphereHordeNavSpawnPoints>(this);
+		NavSpawnPoints->Initialize(SpawnRules.MaxNavPointsPerTile);
+		NavSpawnPointsWaitTime = SpawnRules.NavFirstWaveTimeout;
+	}
+
+	// the rules of the first wave come from the schedule if there is one
+	LoadWaveSchedule();
+	GrownActorsNb = SpawnRules.ActorsNb;
+	LimitedActorsNb = SpawnRules.ActorsNb;
+	UpdateSpawnRulesForWave(CurrentWaveId);
+	PrepareSpawnPolicies();
+
 	// update offset and box height
 	UpdateZoffsetAndBoxHeight();
 
@@ -83,43 +216,111 @@ void ARadialActorsSpawner::BeginPlay()
 	OutterSpawnBoundingBox->SetBoxExtent(BoxExtentOutter);
 	InnerSpawnBoundingBox->SetBoxExtent(BoxExtentInner);
 
+	// the first wave is spawned once its type of actors and vfx are loaded
+	RequestWaveAssets(CurrentWaveId, FStreamableDelegate::CreateUObject(this, &ARadialActorsSpawner::SpawnFirstWave));
+}
+
+// spawns the first wave, once its assets are loaded
+void	ARadialActorsSpawner::SpawnFirstWave()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
 	// set the size of the bounding box
 	SetSpawnerPosition();
+
+	// the first wave waits in Tick until enough reachable points are cached or the wait times out
+	if (NavSpawnPoints && NavSpawnPointsWaitTime > 0.f && NavSpawnPoints->CountPoints(GetActorLocation(), BoxExtentOutter) < SpawnRules.ActorsNb)
+	{
+		bIsWaitingForNavSpawnPoints = true;
+		return;
+	}
+	bIsWaitingForNavSpawnPoints = false;
+
+	// the pool is filled for the largest wave of the schedule while the level loads, the waves of the other types of actors spawn theirs
+	PrespawnPooledTargets(GetSpawnObjectForWave(CurrentWaveId).Get(), GetMaxScheduledActorsNb());
+
 	// spawn new objects in inner radius
-	SpawnTargetSpheres(SpawnRules.InnerRadiusActorsNb, InnerSpawnBoundingBox->Bounds.BoxExtent, SpawnRules.InnerSpawnRadius);
+	SpawnTargetSpheres(SpawnRules.InnerRadiusActorsNb, InnerSpawnBoundingBox->Bounds.BoxExtent, SpawnRules.InnerSpawnRadius, CurrentWaveId, false);
 	// spawn new objects in outter radius
-	SpawnTargetSpheres(SpawnRules.ActorsNb - SpawnRules.InnerRadiusActorsNb, OutterSpawnBoundingBox->Bounds.BoxExtent, SpawnRules.OutterSpawnRadius);
+	SpawnTargetSpheres(SpawnRules.ActorsNb - SpawnRules.InnerRadiusActorsNb, OutterSpawnBoundingBox->Bounds.BoxExtent, SpawnRules.OutterSpawnRadius, CurrentWaveId, false);
+
+	CaptureCurrentWaveState();
+	HandOverTargetsToMovingHorde();
+	ReplicateStartedWave();
+
+	FinishWaveSpawnTiming(StartTime);
 }
 
 // Called every frame
 void ARadialActorsSpawner::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+
+	// measure the real frame time and the game thread time of the previous frame
+	const double NowSeconds = FPlatformTime::Seconds();
+	if (LastTickSeconds > 0.0)
+	{
+		PerfGovernor.AddFrame((float)((NowSeconds - LastTickSeconds) * 1000.0), FPlatformTime::ToMilliseconds(GGameThreadTime));
+	}
+	LastTickSeconds = NowSeconds;
+
+	// look for the reachable points around the pawn, where the next wave is going to be placed
+	if (NavSpawnPoints)
+	{
+		NavSpawnPoints->RequestPoints(GetHordePawn(), BoxExtentOutter, SpawnRules.NavQueriesPerTick, SpawnRules.ActorsNb * 2, SpawnStream);
+
+		if (bIsWaitingForNavSpawnPoints)
+		{
+			NavSpawnPointsWaitTime -= DeltaTime;
+			SpawnFirstWave();
+		}
+	}
+
+	// place a part of the next wave each frame while it is being prepared,
+	// the placement waits for the type of actors of the wave to be loaded
+	if (bIsPreparingNextWave && GetSpawnObjectForWave(PreparedWaveId).Get())
+	{
+		const int32 ActorsPerTick = CVarHordeSpawnActorsPerTick.GetValueOnGameThread();
+		ContinuePreparingNextWave((ActorsPerTick > 0) ? ActorsPerTick : SpawnRules.PreparedActorsPerTick);
+	}
+
+	// give the actors to the targets the pawn comes close to, and take them from the targets it leaves
+	if (IsTargetStreamingEnabled())
+	{
+		StreamingUpdateTime -= DeltaTime;
+		if (StreamingUpdateTime <= 0.f)
+		{
+			StreamingUpdateTime = StreamingUpdateInterval;
+			UpdateTargetStreaming(MaxStreamedTargetsPerUpdate);
+		}
+	}
 }
 
 // sets the spawner position, taking into account player pawn position
 // adjusts its position
 void	ARadialActorsSpawner::SetSpawnerPosition()
 {
-	APawn* PlayerPawn = GetWorld()->GetFirstPlayerController()->GetPawn();
-	FVector PawnLocation = PlayerPawn->GetActorLocation();
+	APawn* PlayerPawn = GetHordePawn();
 	if (PlayerPawn)
 	{
 		// take player position and place spawner and adjust its position
+		FVector PawnLocation = PlayerPawn->GetActorLocation();
 		PawnLocation.Z += zOffset;
 		SetActorLocation(PawnLocation);
 	}
 }
 
-// get all sphere target actors on level
-TArray<AActor*>	ARadialActorsSpawner::GetTargetsOnLevel() const
+// get the pawn the horde is spawned around from the game mode, the first player pawn if there is no game mode
+APawn*	ARadialActorsSpawner::GetHordePawn() const
 {
+	ASphereHordeGameMode* GameMode = GetWorld()->GetAuthGameMode<ASphereHordeGameMode>();
+	if (GameMode)
+	{
+		return GameMode->GetHordePawn();
+	}
 
-	TArray<AActor*>	ResultingArray;
-
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), ASphereTarget::StaticClass(),ResultingArray);
-
-	return ResultingArray;
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	return PlayerController ? PlayerController->GetPawn() : nullptr;
 }
 
 // updates the box extent of the inner and outter box
@@ -140,127 +341,1052 @@ void	ARadialActorsSpawner::UpdateZoffsetAndBoxHeight()
 }
 
 // spawns a N number of target spheres
-void	ARadialActorsSpawner::SpawnTargetSpheres(int32 NbOfSpheres, const FVector& BoxExtent, float Radius)
+int32	ARadialActorsSpawner::SpawnTargetSpheres(int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden)
 {
-	// check if SpawnObject is defined
-	if (!SpawnRules.SpawnObject)
+	// check if SpawnObject is defined and loaded
+	UClass* SpawnClass = GetSpawnObjectForWave(WaveId).Get();
+	if (!SpawnClass)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("SpawnRules.SpawnObject is NOT set"))
+		UE_LOG(LogTemp, Warning, TEXT("SpawnRules.SpawnObject is NOT set or NOT loaded"))
+		return 0;
+	}
+
+	return SpawnTargetSpheresInArea(SpawnClass, NbOfSpheres, BoxExtent, Radius, WaveId, bSpawnHidden);
+}
+
+// places the targets with the default spawn policies, the random points in the box kept apart from each other with the stepped scale
+int32	ARadialActorsSpawner::SpawnTargetSpheresInArea(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden)
+{
+	return SpawnTargetSpheresWithPolicies<FBoxSpawnSampler, FSpacingSpawnValidator, FSteppedSpawnScaler>(SpawnClass, NbOfSpheres, BoxExtent, Radius, WaveId, bSpawnHidden);
+}
+
+// the default spawn policies need no data
+void	ARadialActorsSpawner::PrepareSpawnPolicies()
+{
+}
+
+// the default spawn policies do not use the precomputed point sets
+const FSphereHordeLatticeCache*	ARadialActorsSpawner::GetLatticeCache() const
+{
+	return nullptr;
+}
+
+// collects the inner and the outter spawn radii of the waves up to WavesNb, the radii are set the same way UpdateSpawnRulesForWave sets them,
+// the radii grow by the percentage steps only when there is no schedule, the schedule repeats its last row for the waves after it
+void	ARadialActorsSpawner::GetWaveSpawnRadii(int32 WavesNb, TArray<float>& OutRadii) const
+{
+	float InnerSpawnRadius = SpawnRules.InnerSpawnRadius;
+	float OutterSpawnRadius = SpawnRules.OutterSpawnRadius;
+	for (int32 WaveId = 1; WaveId <= WavesNb; WaveId++)
+	{
+		const FSphereHordeWaveScheduleRow* WaveScheduleRow = GetWaveScheduleRow(WaveId);
+		if (WaveScheduleRow)
+		{
+			InnerSpawnRadius = WaveScheduleRow->InnerSpawnRadius;
+			OutterSpawnRadius = FMath::Max(WaveScheduleRow->OutterSpawnRadius, WaveScheduleRow->InnerSpawnRadius);
+		}
+		else if (WaveId > 1)
+		{
+			OutterSpawnRadius = GetGrownOutterSpawnRadius(OutterSpawnRadius);
+		}
+		OutRadii.AddUnique(InnerSpawnRadius);
+		OutRadii.AddUnique(OutterSpawnRadius);
+	}
+	OutRadii.Sort();
+}
+
+// get the outter spawn radius of the next wave grown by the percentage step
+float	ARadialActorsSpawner::GetGrownOutterSpawnRadius(float OutterSpawnRadius) const
+{
+	return OutterSpawnRadius + OutterSpawnRadius * (SpawnRules.SpawnRadiusStep / 100.f);
+}
+
+// fills the state the spawn policies read, returns false if there is no pawn to spawn the targets around
+bool	ARadialActorsSpawner::MakeSpawnContext(const FVector& BoxExtent, float Radius, FSphereHordeSpawnContext& OutContext)
+{
+	APawn* PlayerPawn = GetHordePawn();
+	if (!PlayerPawn)
+	{
+		return false;
+	}
+
+	OutContext.Origin = GetActorLocation();
+	OutContext.PawnLocation = PlayerPawn->GetActorLocation();
+	OutContext.BoxExtent = BoxExtent;
+	OutContext.Radius = Radius;
+	OutContext.DistanceBetweenObjects = SpawnRules.DistanceBetweenObjects;
+	OutContext.MinActorScale = SpawnRules.MinActorScale;
+	OutContext.MaxActorScale = MaxActorScale;
+	OutContext.ScaleActorStep = SpawnRules.ScaleActorStep;
+	OutContext.TargetIndex = &TargetIndex;
+	OutContext.DormantTargets = IsTargetStreamingEnabled() ? &DormantTargets : nullptr;
+	OutContext.MovingHorde = MovingHorde;
+	OutContext.LatticeCache = GetLatticeCache();
+	OutContext.Stream = &SpawnStream;
+	return true;
+}
+
+// gathers the cached reachable points in the box, returns false if the targets are not spawned on the navmesh
+bool	ARadialActorsSpawner::GatherNavSpawnPoints(const FVector& BoxExtent, TArray<FVector>& OutPoints) const
+{
+	if (!NavSpawnPoints)
+	{
+		return false;
+	}
+
+	NavSpawnPoints->GatherPoints(GetActorLocation(), BoxExtent, OutPoints);
+	return true;
+}
+
+// sets the time the wave took to start and records it to the telemetry
+void	ARadialActorsSpawner::FinishWaveSpawnTiming(double StartTime)
+{
+	LastWaveSpawnMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	ASphereHordeGameMode* GameMode = GetWorld()->GetAuthGameMode<ASphereHordeGameMode>();
+	if (GameMode)
+	{
+		GameMode->RecordTelemetry(ESphereHordeTelemetryEvent::WaveSpawn, GetActorLocation(), CurrentWaveId, LastWaveSpawnMs);
+	}
+}
+
+// records the targets of the wave that could not be placed to the telemetry
+void	ARadialActorsSpawner::RecordPlacementFailure(int32 WaveId, int32 MissingTargetsNb) const
+{
+	ASphereHordeGameMode* GameMode = GetWorld()->GetAuthGameMode<ASphereHordeGameMode>();
+	if (GameMode)
+	{
+		GameMode->RecordTelemetry(ESphereHordeTelemetryEvent::PlacementFailure, GetActorLocation(), WaveId, MissingTargetsNb);
+	}
+}
+
+// places the target of the wave at the location, sets its scale and tags it
+bool	ARadialActorsSpawner::PlaceTarget(UClass* SpawnClass, const FVector& Location, float Scale, int32 WaveId, bool bSpawnHidden)
+{
+	// the targets far from the pawn are kept as the records, they get their actors once the wave is started and the pawn comes close
+	APawn* PlayerPawn = IsTargetStreamingEnabled() ? GetHordePawn() : nullptr;
+	if (PlayerPawn && FVector::DistSquared(Location, PlayerPawn->GetActorLocation()) > FMath::Square(MaterializeRadius))
+	{
+		FSphereTargetRecord Record;
+		Record.Location = Location;
+		Record.Scale = Scale;
+		Record.WaveId = WaveId;
+		Record.Shell = GetShellAtLocation(Location);
+		DormantTargets.Add(Record);
+
+		ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+		if (GameMode)
+		{
+			GameMode->RegisterSpawnedTarget(Record.WaveId, Record.Shell);
+		}
+		return true;
+	}
+
+	ASphereTarget* CreatedTarget = AcquireTarget(SpawnClass, Location);
+	if (!CreatedTarget)
+	{
+		return false;
+	}
+
+	CreatedTarget->SetActorScale3D(FVector(Scale));
+
+	// the targets of the prepared wave stay hidden until the wave starts
+	CreatedTarget->SetTargetEnabled(!bSpawnHidden);
+	if (bSpawnHidden)
+	{
+		PreparedTargets.Add(CreatedTarget);
+	}
+	PlacedTargets.Add(CreatedTarget);
+	TargetIndex.Add(CreatedTarget);
+
+	// tag the target with its wave and shell once its final position is known
+	TagSpawnedTarget(CreatedTarget, WaveId);
+	return true;
+}
+
+// takes a disabled target of the class from the pool and moves it to the location,
+// spawns a new target if there is no such target in the pool
+ASphereTarget*	ARadialActorsSpawner::AcquireTarget(UClass* SpawnClass, const FVector& Location, ESpawnActorCollisionHandlingMethod CollisionHandling)
+{
+	for (int32 i = PooledTargets.Num() - 1; i >= 0; i--)
+	{
+		ASphereTarget* PooledTarget = PooledTargets[i];
+		if (IsValid(PooledTarget) && PooledTarget->GetClass() == SpawnClass)
+		{
+			PooledTargets.RemoveAtSwap(i, 1, false);
+			PooledTarget->SetActorLocation(Location, false, nullptr, ETeleportType::TeleportPhysics);
+			return PooledTarget;
+		}
+	}
+
+	// we specify actor spawn parameters to nake it take into account collision with other objects on scene
+	// by default Actor will try to find a nearby non-colliding location (based on shape components), but will NOT spawn unless one is found
+	FActorSpawnParameters SpawnActorParameters;
+	SpawnActorParameters.SpawnCollisionHandlingOverride = CollisionHandling;
+
+	return GetWorld()->SpawnActor<ASphereTarget>(SpawnClass, Location, FRotator::ZeroRotator, SpawnActorParameters);
+}
+
+// get the type of actors to spawn in the wave, the schedule has the priority,
+// then the variants are cycled through if there are any
+TSoftClassPtr<ASphereTarget>	ARadialActorsSpawner::GetSpawnObjectForWave(int32 WaveId) const
+{
+	const FSphereHordeWaveScheduleRow* WaveScheduleRow = GetWaveScheduleRow(WaveId);
+	if (WaveScheduleRow && !WaveScheduleRow->SpawnObject.IsNull())
+	{
+		return WaveScheduleRow->SpawnObject;
+	}
+
+	if (SpawnRules.WaveSpawnObjectVariants.Num() > 0)
+	{
+		const int32 VariantIndex = FMath::Max(WaveId - 1, 0) % SpawnRules.WaveSpawnObjectVariants.Num();
+		if (!SpawnRules.WaveSpawnObjectVariants[VariantIndex].IsNull())
+		{
+			return SpawnRules.WaveSpawnObjectVariants[VariantIndex];
+		}
+	}
+
+	return SpawnRules.SpawnObject;
+}
+
+// get the row of the wave schedule that describes the wave, the last row describes all the waves after it
+const FSphereHordeWaveScheduleRow*	ARadialActorsSpawner::GetWaveScheduleRow(int32 WaveId) const
+{
+	if (WaveScheduleRows.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	return &WaveScheduleRows[FMath::Clamp(WaveId - 1, 0, WaveScheduleRows.Num() - 1)];
+}
+
+// get the largest number of actors of a wave in the schedule
+int32	ARadialActorsSpawner::GetMaxScheduledActorsNb() const
+{
+	int32 MaxActorsNb = 0;
+	for (const FSphereHordeWaveScheduleRow& WaveScheduleRow : WaveScheduleRows)
+	{
+		MaxActorsNb = FMath::Max(MaxActorsNb, WaveScheduleRow.ActorsNb);
+	}
+
+	return MaxActorsNb;
+}
+
+// copies the rows of the wave schedule table once, so the waves do not look the rows up by name,
+// and reserves the arrays of the targets, so they do not grow during the waves
+void	ARadialActorsSpawner::LoadWaveSchedule()
+{
+	WaveScheduleRows.Reset();
+	if (!SpawnRules.WaveSchedule)
+	{
+		return;
+	}
+
+	if (SpawnRules.WaveSchedule->GetRowStruct() != FSphereHordeWaveScheduleRow::StaticStruct())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SpawnRules.WaveSchedule rows are NOT FSphereHordeWaveScheduleRow, the schedule is ignored"))
 		return;
 	}
 
-	// run the loop until needed number of the targets will not be created
-	int32 spawnedTargetsNb = 0;
-	FVector SpawnPointLocation;
+	const TMap<FName, uint8*>& RowMap = SpawnRules.WaveSchedule->GetRowMap();
+	WaveScheduleRows.Reserve(RowMap.Num());
+	for (const TPair<FName, uint8*>& Row : RowMap)
+	{
+		FSphereHordeWaveScheduleRow& WaveScheduleRow = WaveScheduleRows.Add_GetRef(*reinterpret_cast<const FSphereHordeWaveScheduleRow*>(Row.Value));
+		ValidateWaveScheduleRow(WaveScheduleRow, Row.Key);
+	}
 
-	// spawn attempts to create a new wave a targets
-	int32 SpawnAttempts = 0;
-	int32 AttemptsNumber = 1000;
+	// the placed targets of the current and the prepared wave, the outter targets of the previous waves
+	// are not counted, the pool holds at most a wave of targets as only the in range targets are killed
+	const int32 MaxActorsNb = GetMaxScheduledActorsNb();
+	PlacedTargets.Reserve(MaxActorsNb * 2);
+	PreparedTargets.Reserve(MaxActorsNb);
+	PooledTargets.Reserve(MaxActorsNb);
+}
 
-	while (spawnedTargetsNb < NbOfSpheres && SpawnAttempts < AttemptsNumber)
+// clamps the row so its wave can end, the game mode starts the next wave after a number of the in range kills,
+// so a wave with less in range targets, or with the inner targets placed out of the in range radius, is never finished
+void	ARadialActorsSpawner::ValidateWaveScheduleRow(FSphereHordeWaveScheduleRow& WaveScheduleRow, const FName& RowName) const
+{
+	if (WaveScheduleRow.InnerRadiusActorsNb < MinInnerRadiusActorsNb)
 	{
-		SpawnAttempts++;
+		UE_LOG(LogTemp, Warning, TEXT("The wave schedule row %s has %d in range actors, less than the %d kills of a wave, it is clamped"),
+			*RowName.ToString(), WaveScheduleRow.InnerRadiusActorsNb, MinInnerRadiusActorsNb)
+		WaveScheduleRow.InnerRadiusActorsNb = MinInnerRadiusActorsNb;
+	}
 
-		// get a random point in the bounding sphere and spawn an TargetSphere
-		// we specify actor spawn parameters to nake it take into account collision with other objects on scene
-		// Actor will try to find a nearby non-colliding location (based on shape components), but will NOT spawn unless one is found
-		FActorSpawnParameters SpawnActorParameters;
-		SpawnActorParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+	if (WaveScheduleRow.ActorsNb < WaveScheduleRow.InnerRadiusActorsNb)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("The wave schedule row %s has %d actors, less than its %d in range actors, it is clamped"),
+			*RowName.ToString(), WaveScheduleRow.ActorsNb, WaveScheduleRow.InnerRadiusActorsNb)
+		WaveScheduleRow.ActorsNb = WaveScheduleRow.InnerRadiusActorsNb;
+	}
 
-		// get the random point for spawning in the boxExtent
-		// or random reachable point in radius
-		SpawnPointLocation = UKismetMathLibrary::RandomPointInBoundingBox(GetActorLocation(), BoxExtent);
+	if (WaveScheduleRow.InnerSpawnRadius > SpawnRules.InRangeRadius)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("The wave schedule row %s has the inner spawn radius %.1f over the in range radius %.1f, it is clamped"),
+			*RowName.ToString(), WaveScheduleRow.InnerSpawnRadius, SpawnRules.InRangeRadius)
+		WaveScheduleRow.InnerSpawnRadius = SpawnRules.InRangeRadius;
+	}
+}
 
-		// spawn an actor
-		ASphereTarget* CreatedTarget = GetWorld()->SpawnActor<ASphereTarget>(SpawnRules.SpawnObject, SpawnPointLocation, FRotator::ZeroRotator, SpawnActorParameters);
+// spawns disabled targets of the class into the pool, the pool is not filled over horde.Pool.MaxSize
+void	ARadialActorsSpawner::PrespawnPooledTargets(UClass* SpawnClass, int32 TargetsNb)
+{
+	const int32 MaxPoolSize = CVarHordePoolMaxSize.GetValueOnGameThread();
+	if (MaxPoolSize > 0)
+	{
+		TargetsNb = FMath::Min(TargetsNb, MaxPoolSize - PooledTargets.Num());
+	}
 
-		if (CreatedTarget)
+	if (!SpawnClass || TargetsNb <= 0)
+	{
+		return;
+	}
+
+	// the pooled targets are moved to their locations when they are placed, so they are spawned at the spawner whatever they collide with
+	FActorSpawnParameters SpawnActorParameters;
+	SpawnActorParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	PooledTargets.Reserve(PooledTargets.Num() + TargetsNb);
+	for (int32 i = 0; i < TargetsNb; i++)
+	{
+		ASphereTarget* PooledTarget = GetWorld()->SpawnActor<ASphereTarget>(SpawnClass, GetActorLocation(), FRotator::ZeroRotator, SpawnActorParameters);
+		if (PooledTarget)
+		{
+			PooledTarget->SetTargetEnabled(false);
+			PooledTargets.Add(PooledTarget);
+		}
+	}
+}
+
+// sets the spawn rules of the wave, the schedule row is used if there is a schedule,
+// otherwise the number of actors and the outter radius grow by the percentage steps from the previous wave
+void	ARadialActorsSpawner::UpdateSpawnRulesForWave(int32 WaveId)
+{
+	// a forced wave is not the base of the limit, the next wave is limited against the last wave that was not forced
+	const int32 PreviousActorsNb = LimitedActorsNb;
+
+	const FSphereHordeWaveScheduleRow* WaveScheduleRow = GetWaveScheduleRow(WaveId);
+	if (WaveScheduleRow)
+	{
+		GrownActorsNb = WaveScheduleRow->ActorsNb;
+		SpawnRules.InnerRadiusActorsNb = FMath::Min(WaveScheduleRow->InnerRadiusActorsNb, WaveScheduleRow->ActorsNb);
+		SpawnRules.InnerSpawnRadius = WaveScheduleRow->InnerSpawnRadius;
+		SpawnRules.OutterSpawnRadius = FMath::Max(WaveScheduleRow->OutterSpawnRadius, WaveScheduleRow->InnerSpawnRadius);
+		SpawnRules.MinActorScale = FMath::Min(WaveScheduleRow->MinActorScale, WaveScheduleRow->MaxActorScale);
+		SpawnRules.ScaleActorStep = WaveScheduleRow->ScaleActorStep;
+		SpawnRules.PreparedActorsPerTick = WaveScheduleRow->PreparedActorsPerTick;
+		MaxActorScale = WaveScheduleRow->MaxActorScale;
+	}
+	else if (WaveId > 1)
+	{
+		// update number of actor on the certain percentage, from the grown number and not from the limited one
+		GrownActorsNb += ((float)GrownActorsNb * (SpawnRules.ActorsNbStep / 100.0f));
+		// update spawnRadius of actor on the certain percentage
+		SpawnRules.OutterSpawnRadius = GetGrownOutterSpawnRadius(SpawnRules.OutterSpawnRadius);
+	}
+
+	SpawnRules.ActorsNb = GrownActorsNb;
+
+	// the growth is limited by the measured frame times, the in range targets are kept, so the waves still end,
+	// only the wave being placed is limited, the next wave grows from the unlimited number again
+	if (WaveId > 1)
+	{
+		SpawnRules.ActorsNb = PerfGovernor.LimitActorsNb(PreviousActorsNb, GrownActorsNb, SpawnRules.InnerRadiusActorsNb);
+		if (SpawnRules.ActorsNb < GrownActorsNb)
 		{
-			CreatedTarget->SetActorScale3D(FVector(CurrentActorScale));
-			// calculate and set new scale, skip first spawned item
-			CurrentActorScale = FMath::Clamp((CurrentActorScale - SpawnRules.ScaleActorStep), SpawnRules.MinActorScale, 1.f);
-
-			int32 AttemptsToFindPosition = 0;
-			while (!isActorFarFromSpawnedActors(CreatedTarget, Radius) && AttemptsToFindPosition < AttemptsNumber)
-			{ 
-				SpawnPointLocation = UKismetMathLibrary::RandomPointInBoundingBox(GetActorLocation(), BoxExtent);
-				CreatedTarget->SetActorLocation(SpawnPointLocation);
-				AttemptsToFindPosition++;
+			UE_LOG(LogTemp, Log, TEXT("The wave %d is limited to %d of %d actors, the load is %.2f of the frame budget"), WaveId, SpawnRules.ActorsNb, GrownActorsNb, PerfGovernor.GetLoad())
+		}
+
+		// the live targets of the previous waves and the new wave stay under the cap, the in range targets are kept
+		const int32 MaxLiveTargets = CVarHordeMaxLiveTargets.GetValueOnGameThread();
+		ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+		if (MaxLiveTargets > 0 && GameMode)
+		{
+			const int32 CappedActorsNb = FMath::Max(SpawnRules.InnerRadiusActorsNb, FMath::Min(SpawnRules.ActorsNb, MaxLiveTargets - GameMode->GetLiveTargetsNumber()));
+			if (CappedActorsNb < SpawnRules.ActorsNb)
+			{
+				UE_LOG(LogTemp, Log, TEXT("The wave %d is capped to %d of %d actors by horde.MaxLiveTargets"), WaveId, CappedActorsNb, SpawnRules.ActorsNb)
+				SpawnRules.ActorsNb = CappedActorsNb;
 			}
+		}
+	}
+
+	LimitedActorsNb = SpawnRules.ActorsNb;
+
+	// the forced size replaces the limited one for this wave only, it is not limited, as it is meant for the stress tests
+	ApplyForcedActorsNb();
+
+	// reset the actor scale
+	CurrentActorScale = MaxActorScale;
+}
+
+// get the time the last wave took to start on the game thread, in milliseconds
+float	ARadialActorsSpawner::GetLastWaveSpawnMs() const
+{
+	return LastWaveSpawnMs;
+}
+
+// get the replicated horde, nullptr in the standalone games
+ASphereHordeReplicatedHorde*	ARadialActorsSpawner::GetReplicatedHorde() const
+{
+	return ReplicatedHorde;
+}
+
+// get the moving horde, nullptr if the targets do not move
+ASphereHordeMovingHorde*	ARadialActorsSpawner::GetMovingHorde() const
+{
+	return MovingHorde;
+}
+
+// adds the visible placed targets that are not replicated yet to the replicated horde,
+// the hidden targets of the prepared wave are added when the wave starts
+void	ARadialActorsSpawner::ReplicateStartedWave()
+{
+	if (!ReplicatedHorde)
+	{
+		return;
+	}
+
+	for (ASphereTarget* PlacedTarget : PlacedTargets)
+	{
+		if (IsValid(PlacedTarget) && PlacedTarget->GetNetTargetId() == INDEX_NONE && !PreparedTargets.Contains(PlacedTarget))
+		{
+			PlacedTarget->SetNetTargetId(ReplicatedHorde->AddTarget(PlacedTarget->GetActorLocation(), PlacedTarget->GetActorScale3D().X));
+		}
+	}
+}
+
+// removes the target from the replicated horde, the clients hide it with the next replication of the horde
+void	ARadialActorsSpawner::StopReplicatingTarget(ASphereTarget* Target)
+{
+	if (ReplicatedHorde && Target->GetNetTargetId() != INDEX_NONE)
+	{
+		ReplicatedHorde->RemoveTarget(Target->GetNetTargetId());
+	}
+	Target->SetNetTargetId(INDEX_NONE);
+}
+
+// requests the asynchronous load of the type of actors of the wave, the assets it references
+// are requested once the class is loaded, as they are known only from its default object
+void	ARadialActorsSpawner::RequestWaveAssets(int32 WaveId, FStreamableDelegate OnLoaded)
+{
+	const TSoftClassPtr<ASphereTarget> WaveSpawnObject = GetSpawnObjectForWave(WaveId);
+	if (WaveSpawnObject.IsNull())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SpawnRules.SpawnObject is NOT set"))
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
 
-			if (AttemptsToFindPosition == 1000)
+	// the deterministic spawning can not wait for the streaming, the time it takes differs between the runs
+	if (bDeterministicSpawning)
+	{
+		WaveSpawnObject.LoadSynchronous();
+		OnWaveSpawnObjectLoaded(WaveSpawnObject, WaveId, OnLoaded);
+		return;
+	}
+
+	FStreamableManager& Streamable = UAssetManager::GetStreamableManager();
+	WaveAssetHandles.FindOrAdd(WaveId).Add(Streamable.RequestAsyncLoad(WaveSpawnObject.ToSoftObjectPath(),
+		FStreamableDelegate::CreateUObject(this, &ARadialActorsSpawner::OnWaveSpawnObjectLoaded, WaveSpawnObject, WaveId, OnLoaded)));
+}
+
+// requests the load of the assets referenced by the loaded type of actors
+void	ARadialActorsSpawner::OnWaveSpawnObjectLoaded(TSoftClassPtr<ASphereTarget> LoadedSpawnObject, int32 WaveId, FStreamableDelegate OnLoaded)
+{
+	TArray<FSoftObjectPath> AssetsToLoad;
+	if (UClass* SpawnClass = LoadedSpawnObject.Get())
+	{
+		SpawnClass->GetDefaultObject<ASphereTarget>()->GetAssetsToPreload(AssetsToLoad);
+	}
+
+	if (AssetsToLoad.Num() == 0)
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	FStreamableManager& Streamable = UAssetManager::GetStreamableManager();
+	if (bDeterministicSpawning)
+	{
+		WaveAssetHandles.FindOrAdd(WaveId).Add(Streamable.RequestSyncLoad(AssetsToLoad));
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	WaveAssetHandles.FindOrAdd(WaveId).Add(Streamable.RequestAsyncLoad(AssetsToLoad, OnLoaded));
+}
+
+// releases the handles of the waves that are neither current nor prepared, the assets shared with these waves stay loaded by their own handles
+void	ARadialActorsSpawner::ReleaseStaleWaveAssets()
+{
+	for (auto It = WaveAssetHandles.CreateIterator(); It; ++It)
+	{
+		if (It.Key() == CurrentWaveId || (bIsPreparingNextWave && It.Key() == PreparedWaveId))
+		{
+			continue;
+		}
+
+		for (const TSharedPtr<FStreamableHandle>& Handle : It.Value())
+		{
+			if (Handle.IsValid())
 			{
-				UE_LOG(LogTemp, Warning, TEXT("Failed to find proper position :("))
-				CreatedTarget->Destroy();
-				continue;
+				Handle->ReleaseHandle();
 			}
+		}
+		It.RemoveCurrent();
+	}
+}
+
+// get the spatial index over the placed targets
+const FSphereHordeTargetIndex&	ARadialActorsSpawner::GetTargetIndex() const
+{
+	return TargetIndex;
+}
 
-			// increase counter of created targets
-			spawnedTargetsNb++;
+// checks if the next destruction vfx is to be played
+bool	ARadialActorsSpawner::ShouldPlayDestructionVfx()
+{
+	// the vfx spawned in the frame are counted against horde.Vfx.MaxPerFrame
+	if (VfxFrameNumber != GFrameCounter)
+	{
+		VfxFrameNumber = GFrameCounter;
+		VfxPlayedInFrameNb = 0;
+	}
+
+	const int32 MaxVfxPerFrame = CVarHordeVfxMaxPerFrame.GetValueOnGameThread();
+	if (MaxVfxPerFrame > 0 && VfxPlayedInFrameNb >= MaxVfxPerFrame)
+	{
+		return false;
+	}
+
+	if (!PerfGovernor.ShouldPlayVfx())
+	{
+		return false;
+	}
+
+	VfxPlayedInFrameNb++;
+	return true;
+}
+
+// get the load measured by the governor, 1 is the frame budget
+float	ARadialActorsSpawner::GetPerfLoad() const
+{
+	return PerfGovernor.GetLoad();
+}
+
+// seeds the random stream the spawn positions are picked from
+void	ARadialActorsSpawner::SetSpawnSeed(int32 Seed, bool bDeterministic)
+{
+	SpawnStream.Initialize(Seed);
+	bDeterministicSpawning = bDeterministic;
+}
+
+// keeps the disabled target for reuse, or destroys it if the pool is full
+void	ARadialActorsSpawner::AddToPool(ASphereTarget* Target)
+{
+	const int32 MaxPoolSize = CVarHordePoolMaxSize.GetValueOnGameThread();
+	if (MaxPoolSize > 0 && PooledTargets.Num() >= MaxPoolSize)
+	{
+		Target->Destroy();
+		return;
+	}
+
+	PooledTargets.Add(Target);
+}
+
+// get the number of the attempts to find a position for a target, and to place the targets of a spawn call
+int32	ARadialActorsSpawner::GetSpawnAttemptsNumber() const
+{
+	return FMath::Max(CVarHordeSpawnMaxAttempts.GetValueOnGameThread(), 1);
+}
+
+// sets the size of the next wave, if the wave is being prepared already the rest of its targets is placed in the outter radius,
+// or the prepared targets are dropped and the wave is placed again if it is made smaller
+void	ARadialActorsSpawner::ForceNextWaveSize(int32 ActorsNb)
+{
+	if (ActorsNb <= 0)
+	{
+		return;
+	}
+
+	ForcedActorsNb = ActorsNb;
+	if (!bIsPreparingNextWave)
+	{
+		return;
+	}
+
+	const int32 PreparedActorsNb = SpawnRules.ActorsNb;
+	ApplyForcedActorsNb();
+
+	const int32 MissingActorsNb = SpawnRules.ActorsNb - PreparedActorsNb;
+	if (MissingActorsNb > 0)
+	{
+		PendingOutterActorsNb += MissingActorsNb;
+	}
+	else if (MissingActorsNb < 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("The wave %d is prepared with %d actors already, placing it again with %d actors"), PreparedWaveId, PreparedActorsNb, SpawnRules.ActorsNb)
+		DropPreparedWave();
+		PendingInnerActorsNb = SpawnRules.InnerRadiusActorsNb;
+		PendingOutterActorsNb = SpawnRules.ActorsNb - SpawnRules.InnerRadiusActorsNb;
+		CurrentActorScale = MaxActorScale;
+	}
+}
+
+// sets the forced size to the placed wave, the in range targets are never dropped, the kills they give start the next wave
+void	ARadialActorsSpawner::ApplyForcedActorsNb()
+{
+	if (ForcedActorsNb <= 0)
+	{
+		return;
+	}
+
+	SpawnRules.ActorsNb = FMath::Max(ForcedActorsNb, SpawnRules.InnerRadiusActorsNb);
+	ForcedActorsNb = 0;
+}
+
+// removes the targets and the records of the prepared wave, the game mode does not count them anymore
+void	ARadialActorsSpawner::DropPreparedWave()
+{
+	ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+
+	// ReleaseTarget removes the target from the prepared targets, so they are visited from the last one
+	for (int32 i = PreparedTargets.Num() - 1; i >= 0; i--)
+	{
+		ASphereTarget* PreparedTarget = PreparedTargets[i];
+		if (!IsValid(PreparedTarget))
+		{
+			continue;
+		}
+
+		if (GameMode)
+		{
+			GameMode->UnregisterSpawnedTarget(PreparedTarget->GetWaveId(), PreparedTarget->GetShell());
 		}
+		ReleaseTarget(PreparedTarget);
 	}
+	PreparedTargets.Reset();
+
+	TArray<FSphereTargetRecord> DroppedRecords;
+	DormantTargets.TakeWave(PreparedWaveId, DroppedRecords);
+	if (GameMode)
+	{
+		for (const FSphereTargetRecord& DroppedRecord : DroppedRecords)
+		{
+			GameMode->UnregisterSpawnedTarget(DroppedRecord.WaveId, DroppedRecord.Shell);
+		}
+	}
+}
+
+// returns the killed target to the pool of the disabled targets
+void	ARadialActorsSpawner::ReleaseTarget(ASphereTarget* Target)
+{
+	if (!Target)
+	{
+		return;
+	}
+
+	PlacedTargets.RemoveSwap(Target);
+	PreparedTargets.RemoveSwap(Target);
+	TargetIndex.Remove(Target);
+	StopReplicatingTarget(Target);
+
+	Target->SetTargetEnabled(false);
+	AddToPool(Target);
 }
 
-// checks if the distance from the spawned target and the existing one
-// also checks the distance between the spawned target and the player pawn
-// and checks the actor position being in reachable distance from the box radius
-bool	ARadialActorsSpawner::isActorFarFromSpawnedActors(ASphereTarget* SpawnedTarget, float Radius) const
+// checks if the distance from the location and the placed targets is big enough
+// also checks the distance between the location and the player pawn
+// and checks the location being in reachable distance from the box radius
+bool	ARadialActorsSpawner::isLocationFarFromSpawnedActors(const FVector& Location, float Radius) const
 {
 	// get player pawn and check if it is valid
-	APawn* PlayerPawn = GetWorld()->GetFirstPlayerController()->GetPawn();
+	APawn* PlayerPawn = GetHordePawn();
 	if (!PlayerPawn)
 	{
 		return false;
 	}
 
-	TArray<AActor*>	TargetSpheres = GetTargetsOnLevel();
-	// loop through all the target spheres and check the distance
-	for (int i = 0; i < TargetSpheres.Num(); i++)
+	FSphereHordeSpawnContext Context;
+	Context.Origin = GetActorLocation();
+	Context.PawnLocation = PlayerPawn->GetActorLocation();
+	Context.Radius = Radius;
+	Context.DistanceBetweenObjects = SpawnRules.DistanceBetweenObjects;
+	Context.TargetIndex = &TargetIndex;
+	Context.DormantTargets = IsTargetStreamingEnabled() ? &DormantTargets : nullptr;
+	Context.MovingHorde = MovingHorde;
+	return FSpacingSpawnValidator::IsValid(Context, Location);
+}
+
+// tags the placed target with the wave and the shell it landed in,
+// the shell is resolved once here against the spawn origin of the wave, so the spawner moving
+// to the pawn on the next waves does not change whether the target is counted or not
+void	ARadialActorsSpawner::TagSpawnedTarget(ASphereTarget* SpawnedTarget, int32 WaveId) const
+{
+	SpawnedTarget->SetSpawnInfo(WaveId, GetShellAtLocation(SpawnedTarget->GetActorLocation()));
+
+	ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	if (GameMode)
 	{
-		if (IsValid(TargetSpheres[i]) && SpawnedTarget != TargetSpheres[i])
+		GameMode->RegisterSpawnedTarget(SpawnedTarget);
+	}
+}
+
+// resolves the shell of the location against the spawn origin of the wave
+ESphereTargetShell	ARadialActorsSpawner::GetShellAtLocation(const FVector& Location) const
+{
+	const float DistanceToOriginSquared = FVector::DistSquared(Location, GetActorLocation());
+	return (DistanceToOriginSquared <= FMath::Square(SpawnRules.InRangeRadius)) ? ESphereTargetShell::Inner : ESphereTargetShell::Outer;
+}
+
+// checks if the targets far from the pawn are kept as the records, the moving and the replicated hordes need all the targets
+bool	ARadialActorsSpawner::IsTargetStreamingEnabled() const
+{
+	return MaterializeRadius > 0.f && !MovingHorde && !ReplicatedHorde;
+}
+
+// gives the actors to up to TargetsBudget dormant targets of the started waves near the pawn,
+// and takes them from up to TargetsBudget visible targets far from it, the hidden targets of the prepared wave keep their actors
+void	ARadialActorsSpawner::UpdateTargetStreaming(int32 TargetsBudget)
+{
+	APawn* PlayerPawn = GetHordePawn();
+	if (!PlayerPawn)
+	{
+		return;
+	}
+	const FVector PawnLocation = PlayerPawn->GetActorLocation();
+
+	// the actors of the targets the pawn left are returned to the pool, the targets are not killed, so the game mode is not told
+	const float DematerializeRadiusSquared = FMath::Square(MaterializeRadius + DematerializeMargin);
+	int32 DematerializeBudget = TargetsBudget;
+	for (int32 i = PlacedTargets.Num() - 1; i >= 0 && DematerializeBudget > 0; i--)
+	{
+		ASphereTarget* PlacedTarget = PlacedTargets[i];
+		if (!IsValid(PlacedTarget) || !PlacedTarget->IsTargetEnabled() || FVector::DistSquared(PlacedTarget->GetActorLocation(), PawnLocation) <= DematerializeRadiusSquared)
 		{
-			// calculate the distance between new spawned target and all existing targets
-			// between player and new spawned target
-			// between new spawned target and origin
-			float DistanceBetweenPoints = (SpawnedTarget->GetActorLocation() - TargetSpheres[i]->GetActorLocation()).Size();
-			float DistanceBetweenPointAndPlayer = (SpawnedTarget->GetActorLocation() - PlayerPawn->GetActorLocation()).Size();
-			float DistanceBetweenActorAndOrigin = (SpawnedTarget->GetActorLocation() - GetActorLocation()).Size();
-
-			if (DistanceBetweenPoints <= SpawnRules.DistanceBetweenObjects)
-			{
-				return false;
-			}
-			if (DistanceBetweenPointAndPlayer <= SpawnRules.DistanceBetweenObjects)
-			{
-				return false;
-			}
-			if (DistanceBetweenActorAndOrigin >= Radius)
-			{
-				return false;
-			}
+			continue;
 		}
+
+		FSphereTargetRecord Record;
+		Record.Location = PlacedTarget->GetActorLocation();
+		Record.Scale = PlacedTarget->GetActorScale3D().X;
+		Record.WaveId = PlacedTarget->GetWaveId();
+		Record.Shell = PlacedTarget->GetShell();
+		DormantTargets.Add(Record);
+
+		PlacedTargets.RemoveAtSwap(i, 1, false);
+		TargetIndex.Remove(PlacedTarget);
+		PlacedTarget->SetTargetEnabled(false);
+		AddToPool(PlacedTarget);
+		DematerializeBudget--;
 	}
 
-	return true;
+	// the dormant targets near the pawn take the actors from the pool, the records come from the placed targets,
+	// so the positions are not validated again
+	TArray<FSphereTargetRecord> MaterializedRecords;
+	DormantTargets.TakeWithin(PawnLocation, MaterializeRadius, CurrentWaveId, TargetsBudget, MaterializedRecords);
+	for (const FSphereTargetRecord& Record : MaterializedRecords)
+	{
+		UClass* SpawnClass = GetSpawnObjectForWave(Record.WaveId).Get();
+		ASphereTarget* MaterializedTarget = SpawnClass ? AcquireTarget(SpawnClass, Record.Location, ESpawnActorCollisionHandlingMethod::AlwaysSpawn) : nullptr;
+		if (!MaterializedTarget)
+		{
+			// the target stays dormant until the next update
+			DormantTargets.Add(Record);
+			continue;
+		}
+
+		MaterializedTarget->SetActorScale3D(FVector(Record.Scale));
+		MaterializedTarget->SetSpawnInfo(Record.WaveId, Record.Shell);
+		MaterializedTarget->SetTargetEnabled(true);
+		PlacedTargets.Add(MaterializedTarget);
+		TargetIndex.Add(MaterializedTarget);
+	}
 }
 
-// update the spawner parameters
-// such as number of actors and spawn radius
-void	ARadialActorsSpawner::StartNewWave()
+// starts preparing the next wave, updates the spawner parameters
+// such as number of actors and spawn radius, the actors are placed in Tick
+void	ARadialActorsSpawner::PrepareNextWave()
 {
-	// reset the actor scale
-	CurrentActorScale = MaxActorScale;
-	// update number of actor on the certain percentage
-	SpawnRules.ActorsNb += ((float)SpawnRules.ActorsNb * (SpawnRules.ActorsNbStep / 100.0f));
-	// update spawnRadius of actor on the certain percentage and its box extent and its position
-	SpawnRules.OutterSpawnRadius += (SpawnRules.OutterSpawnRadius * (SpawnRules.SpawnRadiusStep / 100.f));
+	if (bIsPreparingNextWave)
+	{
+		return;
+	}
+	bIsPreparingNextWave = true;
+
+	// the targets placed from now on belong to the next wave
+	PreparedWaveId = CurrentWaveId + 1;
+
+	// stream the type of actors of the next wave and its vfx while the current wave is played
+	RequestWaveAssets(PreparedWaveId);
+
+	// update the number of actors, the spawn radius and the actor scale, then the box extents and the position
+	UpdateSpawnRulesForWave(PreparedWaveId);
 	UpdateZoffsetAndBoxHeight();
 	OutterSpawnBoundingBox->SetBoxExtent(BoxExtentOutter);
+	InnerSpawnBoundingBox->SetBoxExtent(BoxExtentInner);
 	// update offset and set new spawner position
 	SetSpawnerPosition();
-	// spawn new objects in inner radius
-	SpawnTargetSpheres(SpawnRules.InnerRadiusActorsNb, InnerSpawnBoundingBox->Bounds.BoxExtent, SpawnRules.InnerSpawnRadius);
-	// spawn new objects in outter radius
-	SpawnTargetSpheres(SpawnRules.ActorsNb - SpawnRules.InnerRadiusActorsNb, OutterSpawnBoundingBox->Bounds.BoxExtent, SpawnRules.OutterSpawnRadius);
+
+	// the number of the objects to place in inner and outter radius
+	PendingInnerActorsNb = SpawnRules.InnerRadiusActorsNb;
+	PendingOutterActorsNb = SpawnRules.ActorsNb - SpawnRules.InnerRadiusActorsNb;
+}
+
+// checks if the next wave is being prepared or is prepared already
+bool	ARadialActorsSpawner::IsPreparingNextWave() const
+{
+	return bIsPreparingNextWave;
+}
+
+// places up to ActorsBudget actors of the prepared wave, the inner radius is filled first
+// if a pass places less actors than requested it ran out of attempts, so the rest of it is dropped
+void	ARadialActorsSpawner::ContinuePreparingNextWave(int32 ActorsBudget)
+{
+	if (PendingInnerActorsNb > 0 && ActorsBudget > 0)
+	{
+		const int32 RequestedActorsNb = FMath::Min(ActorsBudget, PendingInnerActorsNb);
+		const int32 SpawnedActorsNb = SpawnTargetSpheres(RequestedActorsNb, InnerSpawnBoundingBox->Bounds.BoxExtent, SpawnRules.InnerSpawnRadius, PreparedWaveId, true);
+		PendingInnerActorsNb = (SpawnedActorsNb < RequestedActorsNb) ? 0 : PendingInnerActorsNb - SpawnedActorsNb;
+		ActorsBudget -= SpawnedActorsNb;
+	}
+
+	if (PendingOutterActorsNb > 0 && ActorsBudget > 0)
+	{
+		const int32 RequestedActorsNb = FMath::Min(ActorsBudget, PendingOutterActorsNb);
+		const int32 SpawnedActorsNb = SpawnTargetSpheres(RequestedActorsNb, OutterSpawnBoundingBox->Bounds.BoxExtent, SpawnRules.OutterSpawnRadius, PreparedWaveId, true);
+		PendingOutterActorsNb = (SpawnedActorsNb < RequestedActorsNb) ? 0 : PendingOutterActorsNb - SpawnedActorsNb;
+	}
+}
+
+// starts the next wave, if the game mode did not ask to prepare it in advance it is prepared now,
+// the part of the wave that was not placed in the background yet is placed at once, then the wave is revealed
+void	ARadialActorsSpawner::StartNewWave()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	PrepareNextWave();
+
+	// the wave can not be revealed without its type of actors, load it now if the streaming is not finished yet
+	TSoftClassPtr<ASphereTarget> WaveSpawnObject = GetSpawnObjectForWave(PreparedWaveId);
+	if (WaveSpawnObject.IsPending())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("The type of actors of the wave %d is NOT streamed yet, loading it synchronously"), PreparedWaveId)
+		WaveSpawnObject.LoadSynchronous();
+	}
+	ContinuePreparingNextWave(MAX_int32);
+
+	// reveal the prepared targets
+	for (ASphereTarget* PreparedTarget : PreparedTargets)
+	{
+		if (IsValid(PreparedTarget))
+		{
+			PreparedTarget->SetTargetEnabled(true);
+		}
+	}
+	PreparedTargets.Reset();
+
+	CurrentWaveId = PreparedWaveId;
+	bIsPreparingNextWave = false;
+	ReleaseStaleWaveAssets();
+
+	// the dormant targets of the started wave near the pawn get their actors at once, so the wave is revealed whole
+	if (IsTargetStreamingEnabled())
+	{
+		UpdateTargetStreaming(MAX_int32);
+	}
+
+	CaptureCurrentWaveState();
+	HandOverTargetsToMovingHorde();
+	ReplicateStartedWave();
+
+	FinishWaveSpawnTiming(StartTime);
 }
 
+// hands the placed targets of the started wave over to the moving horde, the targets keep their tags,
+// so the game mode counts them the same way, the actors are returned to the pool to place the next waves
+void	ARadialActorsSpawner::HandOverTargetsToMovingHorde()
+{
+	if (!MovingHorde)
+	{
+		return;
+	}
+
+	PooledTargets.Reserve(PooledTargets.Num() + PlacedTargets.Num());
+	for (ASphereTarget* PlacedTarget : PlacedTargets)
+	{
+		if (IsValid(PlacedTarget))
+		{
+			MovingHorde->AddTarget(PlacedTarget->GetActorLocation(), PlacedTarget->GetActorScale3D().X, PlacedTarget->GetWaveId(), PlacedTarget->GetShell());
+			TargetIndex.Remove(PlacedTarget);
+			PlacedTarget->SetTargetEnabled(false);
+			AddToPool(PlacedTarget);
+		}
+	}
+	PlacedTargets.Reset();
+}
+
+// captures the spawn rules of the current wave, the rules of the prepared wave are not saved to the snapshot
+void	ARadialActorsSpawner::CaptureCurrentWaveState()
+{
+	CurrentWaveState.WaveId = CurrentWaveId;
+	CurrentWaveState.ActorsNb = SpawnRules.ActorsNb;
+	CurrentWaveState.InnerRadiusActorsNb = SpawnRules.InnerRadiusActorsNb;
+	CurrentWaveState.InnerSpawnRadius = SpawnRules.InnerSpawnRadius;
+	CurrentWaveState.OutterSpawnRadius = SpawnRules.OutterSpawnRadius;
+	CurrentWaveState.Origin = GetActorLocation();
+}
+
+// writes the spawn rules of the current wave and the live targets to the snapshot,
+// the hidden targets of the prepared wave are skipped, the wave is prepared again after the restore
+void	ARadialActorsSpawner::WriteSnapshot(FSphereHordeSnapshot& Snapshot) const
+{
+	Snapshot.SpawnerState = CurrentWaveState;
+
+	Snapshot.Targets.Reset(PlacedTargets.Num());
+	for (const ASphereTarget* PlacedTarget : PlacedTargets)
+	{
+		if (IsValid(PlacedTarget) && !PreparedTargets.Contains(PlacedTarget))
+		{
+			FSphereTargetRecord& Record = Snapshot.Targets.AddDefaulted_GetRef();
+			Record.Location = PlacedTarget->GetActorLocation();
+			Record.Scale = PlacedTarget->GetActorScale3D().X;
+			Record.WaveId = PlacedTarget->GetWaveId();
+			Record.Shell = PlacedTarget->GetShell();
+		}
+	}
+
+	// the dormant targets of the started waves are live targets as well
+	for (const FSphereTargetRecord& DormantRecord : DormantTargets.GetRecords())
+	{
+		if (DormantRecord.WaveId <= CurrentWaveId)
+		{
+			Snapshot.Targets.Add(DormantRecord);
+		}
+	}
+
+	// and so are the targets handed over to the moving horde
+	if (MovingHorde)
+	{
+		MovingHorde->AppendRecords(Snapshot.Targets);
+	}
+}
+
+// replaces the placed targets and the spawn rules with the ones of the snapshot
+void	ARadialActorsSpawner::RestoreSnapshot(const FSphereHordeSnapshot& Snapshot)
+{
+	// return all the targets to the pool, including the hidden targets of the prepared wave
+	PooledTargets.Reserve(PooledTargets.Num() + PlacedTargets.Num());
+	for (ASphereTarget* PlacedTarget : PlacedTargets)
+	{
+		if (IsValid(PlacedTarget))
+		{
+			StopReplicatingTarget(PlacedTarget);
+			PlacedTarget->SetTargetEnabled(false);
+			AddToPool(PlacedTarget);
+		}
+	}
+	PlacedTargets.Reset();
+	PreparedTargets.Reset();
+	TargetIndex.Reset();
+	DormantTargets.Reset();
+
+	// the moving targets are not replicated, they are handed over before the wave is, so only the instances are cleared
+	if (MovingHorde)
+	{
+		MovingHorde->Reset();
+	}
+
+	// the prepared wave is dropped
+	bIsPreparingNextWave = false;
+	PendingInnerActorsNb = 0;
+	PendingOutterActorsNb = 0;
+
+	// restore the spawn rules of the current wave, the schedule overrides them if there is one
+	const FSphereHordeSpawnerState& State = Snapshot.SpawnerState;
+	CurrentWaveId = State.WaveId;
+	PreparedWaveId = CurrentWaveId;
+	SpawnRules.ActorsNb = State.ActorsNb;
+	GrownActorsNb = State.ActorsNb;
+	LimitedActorsNb = State.ActorsNb;
+	SpawnRules.InnerRadiusActorsNb = State.InnerRadiusActorsNb;
+	SpawnRules.InnerSpawnRadius = State.InnerSpawnRadius;
+	SpawnRules.OutterSpawnRadius = State.OutterSpawnRadius;
+	if (GetWaveScheduleRow(CurrentWaveId))
+	{
+		UpdateSpawnRulesForWave(CurrentWaveId);
+	}
+
+	// restore the box extents and the spawner position
+	UpdateZoffsetAndBoxHeight();
+	OutterSpawnBoundingBox->SetBoxExtent(BoxExtentOutter);
+	InnerSpawnBoundingBox->SetBoxExtent(BoxExtentInner);
+	SetActorLocation(State.Origin);
+	CurrentWaveState = State;
+
+	// the restored targets move again as the targets of a started wave do
+	SpawnTargetsFromRecords(Snapshot.Targets);
+	HandOverTargetsToMovingHorde();
+	ReplicateStartedWave();
+
+	// stream the vfx of the current wave, the type of actors is loaded already
+	ReleaseStaleWaveAssets();
+	RequestWaveAssets(CurrentWaveId);
+}
+
+// places the targets described by the records as they are, the records come from a valid horde,
+// so the positions are not validated and the targets are spawned even if they collide
+void	ARadialActorsSpawner::SpawnTargetsFromRecords(const TArray<FSphereTargetRecord>& Records)
+{
+	ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	PlacedTargets.Reserve(PlacedTargets.Num() + Records.Num());
+
+	// the records far from the pawn stay dormant
+	APawn* PlayerPawn = IsTargetStreamingEnabled() ? GetHordePawn() : nullptr;
+	const float MaterializeRadiusSquared = FMath::Square(MaterializeRadius);
+
+	// the records are grouped by waves, so the class is resolved once per wave in most cases
+	int32 SpawnClassWaveId = INDEX_NONE;
+	UClass* SpawnClass = nullptr;
+
+	for (const FSphereTargetRecord& Record : Records)
+	{
+		if (PlayerPawn && FVector::DistSquared(Record.Location, PlayerPawn->GetActorLocation()) > MaterializeRadiusSquared)
+		{
+			DormantTargets.Add(Record);
+			if (GameMode)
+			{
+				GameMode->RegisterSpawnedTarget(Record.WaveId, Record.Shell);
+			}
+			continue;
+		}
+
+		if (Record.WaveId != SpawnClassWaveId)
+		{
+			// the restore is a debug tool, the classes of the old waves are loaded synchronously if needed
+			TSoftClassPtr<ASphereTarget> WaveSpawnObject = GetSpawnObjectForWave(Record.WaveId);
+			SpawnClass = WaveSpawnObject.IsPending() ? WaveSpawnObject.LoadSynchronous() : WaveSpawnObject.Get();
+			SpawnClassWaveId = Record.WaveId;
+		}
+
+		ASphereTarget* RestoredTarget = SpawnClass ? AcquireTarget(SpawnClass, Record.Location, ESpawnActorCollisionHandlingMethod::AlwaysSpawn) : nullptr;
+		if (!RestoredTarget)
+		{
+			continue;
+		}
+
+		RestoredTarget->SetActorScale3D(FVector(Record.Scale));
+		RestoredTarget->SetSpawnInfo(Record.WaveId, Record.Shell);
+		RestoredTarget->SetTargetEnabled(true);
+		PlacedTargets.Add(RestoredTarget);
+		TargetIndex.Add(RestoredTarget);
+
+		if (GameMode)
+		{
+			GameMode->RegisterSpawnedTarget(RestoredTarget);
+		}
+	}
+}
@@ -4,11 +4,22 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Engine/StreamableManager.h"
+#include "SphereHordeWaveSchedule.h"
+#include "SphereHordeSnapshot.h"
+#include "SphereHordePerfGovernor.h"
+#include "SphereHordeTargetIndex.h"
+#include "SphereHordeDormantTargets.h"
+#include "SphereHordeSpawnPolicies.h"
 #include "RadialActorsSpawner.generated.h"
 
 class UBoxComponent;
 class ASphereTarget;
 class AActor;
+class UDataTable;
+class ASphereHordeMovingHorde;
+class ASphereHordeReplicatedHorde;
+class USphereHordeNavSpawnPoints;
 /*
 	define the struct that describes the rules of the spawning process
 	all the properties are axposed to the blueprint
@@ -19,6 +30,10 @@ class AActor;
 	4. radius of spawn 
 	5. step of changing the amount of spheres in percentages
 	6. step of changing the spawn radius in percentages
+	7. optional wave schedule table, that replaces the percentage steps
+
+	the spawner samples the locations in the box, keeps them apart and steps the scale down,
+	the presets in SphereHordeSpawnerPresets.h combine the other spawn policies
 */
 
 USTRUCT()
@@ -26,9 +41,14 @@ struct FSpawnRules
 {
 	GENERATED_BODY()
 
-	// type of actors to spawn
+	// type of actors to spawn, it is loaded asynchronously before the first wave
+	UPROPERTY(EditDefaultsOnly)
+	TSoftClassPtr<ASphereTarget>	SpawnObject;
+
+	// types of actors to spawn per wave, the wave N spawns the variant (N - 1) % Num,
+	// the SpawnObject is used if the list is empty, each variant is loaded when its wave starts being prepared
 	UPROPERTY(EditDefaultsOnly)
-	TSubclassOf<ASphereTarget>	SpawnObject;
+	TArray<TSoftClassPtr<ASphereTarget>>	WaveSpawnObjectVariants;
 
 	// initial minimum distance between the actors
 	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "80.0", ClampMax = "160.0", UIMin = "80.0", UIMax = "160.0"))
@@ -56,6 +76,9 @@ struct FSpawnRules
 	// number of actors to spawn in inner radius
 	int32	InnerRadiusActorsNb;
 
+	// radius around the spawn origin, the actors spawned within it are counted as in range
+	float	InRangeRadius = 1500.f;
+
 	// minimum scale of the actor to spawn
 	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.1", ClampMax = "0.9", UIMin = "0.1", UIMax = "0.9"))
 	float	MinActorScale = 0.5f;
@@ -65,9 +88,35 @@ struct FSpawnRules
 	float	ScaleActorStep = 0.1f;
 
 	// boolean to swtich from the Gettting random point in the box extent
-	// to the getting random reachable point in area
+	// to the getting random reachable point in area, the points are taken from the navmesh
+	// and the paths to them from the pawn are found asynchronously before the waves need them
 	UPROPERTY(EditDefaultsOnly, Category = "Spawn Settings")
 	bool	SpawnObjectsUnderPawn = false;
+
+	// the height of the targets above the reachable points on the navmesh
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0", ClampMax = "1000.0", UIMin = "0.0", UIMax = "1000.0", EditCondition = "SpawnObjectsUnderPawn"), Category = "Spawn Settings")
+	float	NavSpawnHeightOffset = 100.f;
+
+	// the number of the reachable point queries issued per frame
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "1", ClampMax = "64", UIMin = "1", UIMax = "64", EditCondition = "SpawnObjectsUnderPawn"), Category = "Spawn Settings")
+	int32	NavQueriesPerTick = 8;
+
+	// the maximum number of the reachable points cached per navmesh tile
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "1", ClampMax = "256", UIMin = "1", UIMax = "256", EditCondition = "SpawnObjectsUnderPawn"), Category = "Spawn Settings")
+	int32	MaxNavPointsPerTile = 16;
+
+	// the time the first wave waits for the reachable points to be cached, it is spawned with the points found by then
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0", ClampMax = "10.0", UIMin = "0.0", UIMax = "10.0", EditCondition = "SpawnObjectsUnderPawn"), Category = "Spawn Settings")
+	float	NavFirstWaveTimeout = 2.f;
+
+	// the number of the next wave actors placed per frame while the next wave is prepared in the background
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "1", ClampMax = "200", UIMin = "1", UIMax = "200"), Category = "Spawn Settings")
+	int32	PreparedActorsPerTick = 10;
+
+	// the table of FSphereHordeWaveScheduleRow rows, the row N describes the wave N
+	// when it is set the percentage steps are not used, the waves after the last row repeat it
+	UPROPERTY(EditDefaultsOnly, meta = (RequiredAssetDataTags = "RowStructure=SphereHordeWaveScheduleRow"), Category = "Spawn Settings")
+	UDataTable*	WaveSchedule = nullptr;
 };
 
 UCLASS()
@@ -82,22 +131,105 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
-	// spawns the targets in the area
-	void	SpawnTargetSpheres(int32 NbOfSpheres, const FVector& BoxExtent, float Radius);
+	// spawns the targets in the area, tags them with the wave id and returns the number of the spawned targets
+	// the targets spawned hidden are kept disabled until the wave they belong to is revealed
+	int32	SpawnTargetSpheres(int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden);
 
-	// checks if the distance of the actor is greater than some constant value
-	bool	isActorFarFromSpawnedActors(ASphereTarget* SpawnedTarget, float Radius) const;
+	// checks if the location is far enough from the spawned targets and the player, and inside the radius
+	bool	isLocationFarFromSpawnedActors(const FVector& Location, float Radius) const;
 
 	// update the spawner parameters, number of spheres and radius
+	// reveals the next wave, preparing the part of it which is not prepared yet
 	void	StartNewWave();
 
-	// initialize spawn actors number and spawn actors inside the inner radius
-	void	Initialize(int32 ActorsNb, int32 InnerRadiusNb);
+	// starts preparing the next wave in the background, its targets are placed over several frames
+	// and stay hidden until StartNewWave is called, does nothing if the preparation is already started
+	void	PrepareNextWave();
+
+	// checks if the next wave is being prepared or is prepared already
+	bool	IsPreparingNextWave() const;
+
+	// returns the killed target to the pool of the disabled targets, so the next waves can reuse it
+	void	ReleaseTarget(ASphereTarget* Target);
+
+	// sets the size of the next wave for the stress tests, it replaces the size of that wave only and is not limited by the frame budget,
+	// the in range targets of the wave are kept, so the wave still ends, a smaller size drops the prepared targets to place the wave again
+	void	ForceNextWaveSize(int32 ActorsNb);
+
+	// get the type of actors to spawn in the wave
+	TSoftClassPtr<ASphereTarget>	GetSpawnObjectForWave(int32 WaveId) const;
+
+	// get the replicated horde, nullptr in the standalone games
+	ASphereHordeReplicatedHorde*	GetReplicatedHorde() const;
+
+	// get the moving horde, nullptr if the targets do not move
+	ASphereHordeMovingHorde*	GetMovingHorde() const;
+
+	// get the spatial index over the placed targets, for the queries that do not touch the physics scene
+	const FSphereHordeTargetIndex&	GetTargetIndex() const;
+
+	// checks if the next destruction vfx is to be played, the vfx density is lowered when the game is over its frame budget
+	bool	ShouldPlayDestructionVfx();
+
+	// get the load measured by the governor, 1 is the frame budget
+	float	GetPerfLoad() const;
+
+	// seeds the random stream the spawn positions are picked from, called before the spawner begins play,
+	// the deterministic spawning loads the wave assets synchronously, so the waves are placed on the same frames in a replay
+	void	SetSpawnSeed(int32 Seed, bool bDeterministic);
+
+	// get the time the last wave took to start on the game thread, in milliseconds
+	float	GetLastWaveSpawnMs() const;
+
+	// get the row of the wave schedule that describes the wave, nullptr if there is no schedule
+	const FSphereHordeWaveScheduleRow*	GetWaveScheduleRow(int32 WaveId) const;
+
+	// get the largest number of actors of a wave in the schedule, 0 if there is no schedule
+	int32	GetMaxScheduledActorsNb() const;
+
+	// writes the spawn rules of the current wave and the live targets to the snapshot
+	void	WriteSnapshot(FSphereHordeSnapshot& Snapshot) const;
+
+	// replaces the placed and the moving targets and the spawn rules with the ones of the snapshot,
+	// the targets the game mode registers are counted again, so the game mode should reset its counters first
+	void	RestoreSnapshot(const FSphereHordeSnapshot& Snapshot);
+
+	// requests the asynchronous load of the type of actors of the wave and the assets it references,
+	// OnLoaded is called once everything is loaded
+	void	RequestWaveAssets(int32 WaveId, FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+	// initialize spawn actors number, spawn actors inside the inner radius and the in range radius
+	void	Initialize(int32 ActorsNb, int32 InnerRadiusNb, float InRangeRadius);
+
+	// get the id of the wave that is currently spawned
+	int32	GetCurrentWaveId() const;
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// places the targets with the spawn policies of the spawner, the presets override it with their own policies
+	virtual int32	SpawnTargetSpheresInArea(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden);
+
+	// prepares the data the spawn policies of the presets need, called on begin play once the rules of the first wave are set
+	virtual void	PrepareSpawnPolicies();
+
+	// get the precomputed point sets of the spawn radii, nullptr if the spawner does not build them
+	virtual const FSphereHordeLatticeCache*	GetLatticeCache() const;
+
+	// collects the inner and the outter spawn radii of the waves up to WavesNb, from the schedule or by the percentage steps,
+	// the radii are sorted and each of them is listed once
+	void	GetWaveSpawnRadii(int32 WavesNb, TArray<float>& OutRadii) const;
+
+	// get the outter spawn radius of the next wave grown by the percentage step, the waves grow by it only when there is no schedule,
+	// the schedule repeats its last row for the waves after it
+	float	GetGrownOutterSpawnRadius(float OutterSpawnRadius) const;
+
+	// the spawn loop composed of the sampler, the validator and the scaler, the cached reachable points replace the sampler
+	// when the targets are spawned on the navmesh, each combination is compiled into its own loop with the policies inlined
+	template <typename SamplerType, typename ValidatorType, typename ScalerType>
+	int32	SpawnTargetSpheresWithPolicies(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden);
+
 	// struct that describes the spawn rules
 	UPROPERTY(EditDefaultsOnly)
 	FSpawnRules	SpawnRules;
@@ -110,6 +242,43 @@ protected:
 	UPROPERTY(VisibleAnywhere)
 	UBoxComponent* InnerSpawnBoundingBox;
 
+	// the moving horde, if it is set the placed targets of each wave are handed over to it when the wave starts
+	// and move as the instances of one instanced mesh instead of being the static actors
+	UPROPERTY(EditDefaultsOnly, Category = "Moving Horde")
+	TSubclassOf<ASphereHordeMovingHorde>	MovingHordeClass;
+
+	// the frame budget the growth of the waves is limited by, the in range targets are never cut,
+	// only the outter targets, which are not counted for the next wave
+	UPROPERTY(EditDefaultsOnly, Category = "Performance")
+	FSphereHordePerfBudget	PerfBudget;
+
+	// the size of the cells of the spatial index over the placed targets, in world units
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "50.0", ClampMax = "5000.0", UIMin = "50.0", UIMax = "5000.0"), Category = "Spatial Index")
+	float	TargetIndexCellSize = 500.f;
+
+	// the distance from the pawn the targets get their actors within, the targets further away are kept as the records only,
+	// so the number of the actors depends on the targets near the pawn and not on the size of the horde, 0 turns the streaming off,
+	// it should be larger than the in range radius, the targets are not streamed when they move or are replicated to the clients
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0", UIMin = "0.0"), Category = "Streaming")
+	float	MaterializeRadius = 0.f;
+
+	// the distance beyond the materialize radius the targets keep their actors within, so the targets on the border do not flicker
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0", UIMin = "0.0"), Category = "Streaming")
+	float	DematerializeMargin = 250.f;
+
+	// the max number of the targets that get or lose their actors per streaming update
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "1", UIMin = "1"), Category = "Streaming")
+	int32	MaxStreamedTargetsPerUpdate = 32;
+
+	// the time between the streaming updates, in seconds
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0", UIMin = "0.0"), Category = "Streaming")
+	float	StreamingUpdateInterval = 0.1f;
+
+	// the replicated horde, it is spawned in the networked games only, the started waves are added to it
+	// and the clients render them, the target actors themselves are not replicated
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+	TSubclassOf<ASphereHordeReplicatedHorde>	ReplicatedHordeClass;
+
 private:
 	// the maximum scale of the spawned actor
 	float		MaxActorScale;
@@ -117,9 +286,189 @@ private:
 	// current actor scale
 	float		CurrentActorScale;
 
+	// the number of actors the waves grow to without the limits of the frame budget and the caps,
+	// the next wave grows from it, so a slow stretch only shrinks the waves placed during it
+	int32		GrownActorsNb;
+
+	// the id of the wave that is currently spawned, the spawned targets are tagged with it
+	int32		CurrentWaveId;
+
+	// tags the placed target with the wave and its shell, and registers it in the game mode
+	void	TagSpawnedTarget(ASphereTarget* SpawnedTarget, int32 WaveId) const;
+
+	// the targets that are placed on the level, including the hidden targets of the prepared wave
+	UPROPERTY()
+	TArray<ASphereTarget*>	PlacedTargets;
+
+	// the hidden targets of the next wave, they are enabled when the wave starts
+	UPROPERTY()
+	TArray<ASphereTarget*>	PreparedTargets;
+
+	// the disabled targets that are ready to be placed again
+	UPROPERTY()
+	TArray<ASphereTarget*>	PooledTargets;
+
+	// keeps the disabled target for reuse, or destroys it if the pool is over horde.Pool.MaxSize
+	void	AddToPool(ASphereTarget* Target);
+
+	// get the number of the attempts to find a position for a target, from horde.Spawn.MaxAttempts
+	int32	GetSpawnAttemptsNumber() const;
+
+	// the size of the next wave set by ForceNextWaveSize, 0 if the wave grows as usual
+	int32	ForcedActorsNb;
+
+	// the limited size of the last wave that was not forced, the frame budget limits the growth of the next wave from it
+	int32	LimitedActorsNb;
+
+	// sets the forced size to the placed wave, at least its in range targets are placed
+	void	ApplyForcedActorsNb();
+
+	// removes the targets and the records of the prepared wave, the targets go back to the pool and are not counted anymore
+	void	DropPreparedWave();
+
+	// the frame the vfx were counted in, and the number of the vfx played in it
+	uint64	VfxFrameNumber;
+	int32	VfxPlayedInFrameNb;
+
+	// the spatial index over the placed targets, the targets are added when placed and removed when released
+	FSphereHordeTargetIndex	TargetIndex;
+
+	// the targets far from the pawn that are kept as the records only, the prepared wave included
+	FSphereHordeDormantTargets	DormantTargets;
+
+	// the time left until the next streaming update
+	float	StreamingUpdateTime;
+
+	// checks if the targets far from the pawn are kept as the records
+	bool	IsTargetStreamingEnabled() const;
+
+	// gives the actors to the dormant targets of the started waves near the pawn, and takes them from the visible targets far from it
+	void	UpdateTargetStreaming(int32 TargetsBudget);
+
+	// resolves the shell of the location against the spawn origin of the wave
+	ESphereTargetShell	GetShellAtLocation(const FVector& Location) const;
+
+	// takes a target of the class from the pool and moves it to the location, or spawns a new one if there is none
+	ASphereTarget*	AcquireTarget(UClass* SpawnClass, const FVector& Location, ESpawnActorCollisionHandlingMethod CollisionHandling = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding);
+
+	// places the targets described by the records as they are, without looking for the positions
+	void	SpawnTargetsFromRecords(const TArray<FSphereTargetRecord>& Records);
+
+	// the spawn rules of the current wave, they are captured when the wave starts
+	FSphereHordeSpawnerState	CurrentWaveState;
+
+	// captures the spawn rules of the current wave
+	void	CaptureCurrentWaveState();
+
+	// the spawned moving horde
+	UPROPERTY()
+	ASphereHordeMovingHorde*	MovingHorde;
+
+	// hands the placed targets of the started wave over to the moving horde and returns the actors to the pool
+	void	HandOverTargetsToMovingHorde();
+
+	// the time the last wave took to start on the game thread, in milliseconds
+	float	LastWaveSpawnMs;
+
+	// watches the frame and game thread times, limits the waves and the vfx density
+	FSphereHordePerfGovernor	PerfGovernor;
+
+	// the time of the previous tick, the governor measures the real frame time, not the fixed timestep
+	double	LastTickSeconds;
+
+	// sets the time the wave took to start and records it to the telemetry
+	void	FinishWaveSpawnTiming(double StartTime);
+
+	// records the targets of the wave that could not be placed to the telemetry
+	void	RecordPlacementFailure(int32 WaveId, int32 MissingTargetsNb) const;
+
+	// the spawned replicated horde
+	UPROPERTY()
+	ASphereHordeReplicatedHorde*	ReplicatedHorde;
+
+	// adds the visible placed targets that are not replicated yet to the replicated horde
+	void	ReplicateStartedWave();
+
+	// removes the target from the replicated horde
+	void	StopReplicatingTarget(ASphereTarget* Target);
+
+	// the handles that keep the loaded types of actors and their assets in memory, by the wave they are loaded for,
+	// only the handles of the current and the prepared waves are kept
+	TMap<int32, TArray<TSharedPtr<FStreamableHandle>>>	WaveAssetHandles;
+
+	// releases the handles of the waves that are neither current nor prepared, so their assets can be unloaded
+	void	ReleaseStaleWaveAssets();
+
+	// the random stream the spawn positions are picked from
+	FRandomStream	SpawnStream;
+
+	// true if the wave assets are loaded synchronously, for the recorded and replayed games
+	bool	bDeterministicSpawning;
+
+	// fills the state the spawn policies read, returns false if there is no pawn to spawn the targets around
+	bool	MakeSpawnContext(const FVector& BoxExtent, float Radius, FSphereHordeSpawnContext& OutContext);
+
+	// places the targets at the locations of the sampler that the validator accepts, scaled by the scaler
+	template <typename SamplerType, typename ValidatorType, typename ScalerType>
+	int32	RunSpawnLoop(SamplerType& Sampler, const FSphereHordeSpawnContext& Context, UClass* SpawnClass, int32 NbOfSpheres, int32 WaveId, bool bSpawnHidden);
+
+	// places the target of the wave at the location with the scale, returns false if the target could not be spawned there
+	bool	PlaceTarget(UClass* SpawnClass, const FVector& Location, float Scale, int32 WaveId, bool bSpawnHidden);
+
+	// the cache of the reachable points, created on begin play when the targets are spawned on the navmesh
+	UPROPERTY()
+	USphereHordeNavSpawnPoints*	NavSpawnPoints;
+
+	// gathers the cached reachable points in the box, returns false if the targets are not spawned on the navmesh
+	bool	GatherNavSpawnPoints(const FVector& BoxExtent, TArray<FVector>& OutPoints) const;
+
+	// true while the first wave waits for the reachable points, and the time left to wait
+	bool	bIsWaitingForNavSpawnPoints;
+	float	NavSpawnPointsWaitTime;
+
+	// requests the load of the assets referenced by the loaded type of actors
+	void	OnWaveSpawnObjectLoaded(TSoftClassPtr<ASphereTarget> LoadedSpawnObject, int32 WaveId, FStreamableDelegate OnLoaded);
+
+	// spawns the first wave, once its assets are loaded
+	void	SpawnFirstWave();
+
+	// true from the moment the next wave starts being prepared until it is revealed
+	bool	bIsPreparingNextWave;
+
+	// the id of the wave that is being prepared
+	int32	PreparedWaveId;
+
+	// the number of the actors of the prepared wave still to be placed in the inner and outter radius
+	int32	PendingInnerActorsNb;
+	int32	PendingOutterActorsNb;
+
+	// places up to ActorsBudget actors of the prepared wave
+	void	ContinuePreparingNextWave(int32 ActorsBudget);
+
+	// the rows of the wave schedule, copied once on begin play
+	TArray<FSphereHordeWaveScheduleRow>	WaveScheduleRows;
+
+	// copies the rows of the wave schedule table and reserves the arrays of the targets for the largest wave
+	void	LoadWaveSchedule();
+
+	// the number of the in range targets each wave needs at least, the kills the game mode waits for to start the next wave
+	int32	MinInnerRadiusActorsNb;
+
+	// clamps the row so its wave can end, the in range targets are enough for the kills of the wave and are placed within the in range radius
+	void	ValidateWaveScheduleRow(FSphereHordeWaveScheduleRow& WaveScheduleRow, const FName& RowName) const;
+
+	// spawns disabled targets of the class into the pool, so the largest wave of the schedule does not spawn actors while it is played
+	void	PrespawnPooledTargets(UClass* SpawnClass, int32 TargetsNb);
+
+	// sets the spawn rules of the wave, from the wave schedule or by the percentage steps
+	void	UpdateSpawnRulesForWave(int32 WaveId);
+
 	// sets the spawner position, taking into account player pawn position
 	void	SetSpawnerPosition();
 
+	// get the pawn the horde is spawned around, the player pawn or the pawn of the soak bot
+	APawn*	GetHordePawn() const;
+
 	// the float value that represents Z adjustment of the of the spawner
 	// relatively to the player pawn
 	float	zOffset;
@@ -132,7 +481,93 @@ private:
 
 	// updates the box extent of the inner and outter box
 	void	UpdateZoffsetAndBoxHeight();
-
-	// get number of the actors in the radius
-	TArray<AActor*>	GetTargetsOnLevel() const;
 };
+
+// the spawn loop composed of the policies, the cached reachable points replace the sampler when the targets are spawned on the navmesh
+template <typename SamplerType, typename ValidatorType, typename ScalerType>
+int32	ARadialActorsSpawner::SpawnTargetSpheresWithPolicies(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden)
+{
+	FSphereHordeSpawnContext Context;
+	if (!MakeSpawnContext(BoxExtent, Radius, Context))
+	{
+		RecordPlacementFailure(WaveId, NbOfSpheres);
+		return 0;
+	}
+
+	// the points that are not cached yet are not waited for, the wave gets less targets instead
+	TArray<FVector> NavPoints;
+	if (GatherNavSpawnPoints(BoxExtent, NavPoints))
+	{
+		FNavPointsSpawnSampler NavSampler(NavPoints, SpawnRules.NavSpawnHeightOffset);
+		const int32 spawnedTargetsNb = RunSpawnLoop<FNavPointsSpawnSampler, ValidatorType, ScalerType>(NavSampler, Context, SpawnClass, NbOfSpheres, WaveId, bSpawnHidden);
+		if (spawnedTargetsNb < NbOfSpheres)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Only %d of %d targets are placed, NOT enough reachable points are cached around the spawner"), spawnedTargetsNb, NbOfSpheres)
+		}
+		return spawnedTargetsNb;
+	}
+
+	SamplerType Sampler(Context);
+	return RunSpawnLoop<SamplerType, ValidatorType, ScalerType>(Sampler, Context, SpawnClass, NbOfSpheres, WaveId, bSpawnHidden);
+}
+
+// places the targets at the locations of the sampler that the validator accepts, scaled by the scaler
+template <typename SamplerType, typename ValidatorType, typename ScalerType>
+int32	ARadialActorsSpawner::RunSpawnLoop(SamplerType& Sampler, const FSphereHordeSpawnContext& Context, UClass* SpawnClass, int32 NbOfSpheres, int32 WaveId, bool bSpawnHidden)
+{
+	// run the loop until needed number of the targets will not be created
+	int32 spawnedTargetsNb = 0;
+	FVector SpawnPointLocation;
+
+	// spawn attempts to create a new wave a targets
+	int32 SpawnAttempts = 0;
+	const int32 AttemptsNumber = GetSpawnAttemptsNumber();
+	bool bIsSamplerExhausted = false;
+
+	while (spawnedTargetsNb < NbOfSpheres && SpawnAttempts < AttemptsNumber && !bIsSamplerExhausted)
+	{
+		SpawnAttempts++;
+
+		// find the location far enough from the placed targets before taking a target for it
+		bool bIsPositionFound = false;
+		for (int32 AttemptsToFindPosition = 0; AttemptsToFindPosition < AttemptsNumber; AttemptsToFindPosition++)
+		{
+			if (!Sampler.Sample(Context, SpawnPointLocation))
+			{
+				bIsSamplerExhausted = true;
+				break;
+			}
+			if (ValidatorType::IsValid(Context, SpawnPointLocation))
+			{
+				bIsPositionFound = true;
+				break;
+			}
+		}
+
+		if (!bIsPositionFound)
+		{
+			if (!bIsSamplerExhausted)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Failed to find proper position :("))
+			}
+			continue;
+		}
+
+		// the scale steps only when the target is placed
+		float NextActorScale = CurrentActorScale;
+		const float SpawnScale = ScalerType::NextScale(Context, NextActorScale);
+		if (PlaceTarget(SpawnClass, SpawnPointLocation, SpawnScale, WaveId, bSpawnHidden))
+		{
+			// increase counter of created targets
+			CurrentActorScale = NextActorScale;
+			spawnedTargetsNb++;
+		}
+	}
+
+	if (spawnedTargetsNb < NbOfSpheres)
+	{
+		RecordPlacementFailure(WaveId, NbOfSpheres - spawnedTargetsNb);
+	}
+
+	return spawnedTargetsNb;
+}
@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+/*
+	define the helpers shared by the binary files of the horde, the snapshots, the input logs, the lattice caches and the telemetry,
+	a format declares its magic number, its version and how its payload is serialized, the helpers do the rest
+
+	1. the header of the file, the magic number and the version, the version is bumped on any layout change of the payload
+	2. the arrays of the plain records, written as one raw memory block, their size is checked against the rest of the file on load
+	3. the payload written to and read from the file in one block
+
+	the records written as raw memory have their padding declared as zeroed fields, so the files do not contain uninitialized bytes
+*/
+
+// the magic number and the version the file of a format starts with
+struct FSphereHordeBinaryFormat
+{
+	uint32	Magic;
+	uint32	Version;
+};
+
+// writes the header of the format, or reads it and returns false if the file is of another format or version
+inline bool	SerializeHordeBinaryHeader(FArchive& Ar, const FSphereHordeBinaryFormat& Format)
+{
+	uint32 Magic = Format.Magic;
+	uint32 Version = Format.Version;
+	Ar << Magic;
+	Ar << Version;
+	return !Ar.IsError() && Magic == Format.Magic && Version == Format.Version;
+}
+
+// serializes the number of the elements of an array, on load the archive is set to error
+// if the number is negative or the elements, of at least MinElementSize bytes each, can not fit in the rest of the archive
+inline bool	SerializeHordeArrayNum(FArchive& Ar, int32& ElementsNb, int64 MinElementSize)
+{
+	Ar << ElementsNb;
+	if (Ar.IsLoading() && (ElementsNb < 0 || (int64)ElementsNb * MinElementSize > Ar.TotalSize() - Ar.Tell()))
+	{
+		Ar.SetError();
+	}
+	return !Ar.IsError();
+}
+
+// serializes the array of the plain records as one raw memory block preceded by the record size and the number of the records,
+// the record size is stored to reject the files of other layouts
+template <typename RecordType, typename AllocatorType>
+bool	SerializeHordeRawArray(FArchive& Ar, TArray<RecordType, AllocatorType>& Records)
+{
+	static_assert(TIsTriviallyCopyConstructible<RecordType>::Value && TIsTriviallyDestructible<RecordType>::Value, "the raw records must be plain memory");
+
+	int32 RecordSize = sizeof(RecordType);
+	int32 RecordsNb = Records.Num();
+	Ar << RecordSize;
+	if (Ar.IsLoading() && RecordSize != sizeof(RecordType))
+	{
+		Ar.SetError();
+		return false;
+	}
+
+	if (!SerializeHordeArrayNum(Ar, RecordsNb, sizeof(RecordType)))
+	{
+		return false;
+	}
+
+	if (Ar.IsLoading())
+	{
+		Records.SetNumUninitialized(RecordsNb);
+	}
+	Ar.Serialize(Records.GetData(), (int64)RecordsNb * sizeof(RecordType));
+	return !Ar.IsError();
+}
+
+// writes the header of the format and the payload to the file in one block, ReservedSize is the expected size of the file
+template <typename PayloadType>
+bool	SaveHordeBinaryFile(const FString& FilePath, const FSphereHordeBinaryFormat& Format, const PayloadType& Payload, int32 ReservedSize = 0)
+{
+	TArray<uint8> Buffer;
+	Buffer.Reserve(ReservedSize);
+
+	// the archive operators of the payloads are not const, the writer does not change the payload
+	FMemoryWriter Writer(Buffer, true);
+	SerializeHordeBinaryHeader(Writer, Format);
+	Writer << const_cast<PayloadType&>(Payload);
+
+	return FFileHelper::SaveArrayToFile(Buffer, *FilePath);
+}
+
+// reads the payload from the file, returns false if the file is missing, is of another format or version, or is truncated
+template <typename PayloadType>
+bool	LoadHordeBinaryFile(const FString& FilePath, const FSphereHordeBinaryFormat& Format, PayloadType& Payload)
+{
+	TArray<uint8> Buffer;
+	if (!FFileHelper::LoadFileToArray(Buffer, *FilePath))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Buffer, true);
+	if (!SerializeHordeBinaryHeader(Reader, Format))
+	{
+		return false;
+	}
+
+	Reader << Payload;
+	return !Reader.IsError();
+}
@@ -0,0 +1,249 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeBotController.h"
+#include "SphereHordeCharacter.h"
+#include "SphereHordeGameMode.h"
+#include "RadialActorsSpawner.h"
+#include "SphereTarget.h"
+#include "AITypes.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "UObject/UObjectArray.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSoakBot, Log, All);
+
+// Sets default values
+ASphereHordeBotController::ASphereHordeBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	BotCharacter = nullptr;
+	FireCooldown = 0.f;
+	TargetAimTime = 0.f;
+	SoakStartTime = 0.0;
+	WaveStartTime = 0.0;
+	LoggedWaveNumber = 1;
+	bIsFinished = false;
+}
+
+// checks if the soak bot is requested from the command line
+bool ASphereHordeBotController::IsSoakBotRequested()
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("SoakBot"));
+}
+
+// Called when the game starts or when spawned
+void ASphereHordeBotController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// the command line overrides the defaults
+	FParse::Value(FCommandLine::Get(), TEXT("SoakFireRate="), FireRate);
+	FParse::Value(FCommandLine::Get(), TEXT("SoakMaxWave="), MaxWave);
+	FParse::Value(FCommandLine::Get(), TEXT("SoakMaxSeconds="), MaxSeconds);
+	FParse::Value(FCommandLine::Get(), TEXT("SoakTargetTimeout="), TargetTimeout);
+	FireRate = FMath::Max(FireRate, 0.1f);
+
+	SoakStartTime = FPlatformTime::Seconds();
+	WaveStartTime = SoakStartTime;
+
+	ASphereHordeGameMode* GameMode = GetWorld()->GetAuthGameMode<ASphereHordeGameMode>();
+	if (GameMode)
+	{
+		GameMode->OnScoreChanged.AddUObject(this, &ASphereHordeBotController::OnScoreChanged);
+		LoggedWaveNumber = GameMode->GetCurrentWaveNumber();
+	}
+
+	UE_LOG(LogSoakBot, Log, TEXT("Soak started: fire rate %.1f, max wave %d, max seconds %.0f"), FireRate, MaxWave, MaxSeconds)
+}
+
+void ASphereHordeBotController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	BotCharacter = Cast<ASphereHordeCharacter>(InPawn);
+	if (!BotCharacter)
+	{
+		UE_LOG(LogSoakBot, Warning, TEXT("The soak bot possessed a pawn that is NOT ASphereHordeCharacter"))
+	}
+}
+
+// Called every frame
+void ASphereHordeBotController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (bIsFinished || !BotCharacter)
+	{
+		return;
+	}
+
+	if (MaxSeconds > 0.f && FPlatformTime::Seconds() - SoakStartTime >= MaxSeconds)
+	{
+		FinishSoak(TEXT("time limit reached"));
+		return;
+	}
+
+	// pick the next target once the current one is destroyed, or once it stays unhit for too long,
+	// the dropped target is skipped by the next search so the bot does not pick it again at once
+	ASphereTarget* Target = CurrentTarget.Get();
+	TargetAimTime += DeltaTime;
+	const bool bIsTargetStale = (TargetTimeout > 0.f && TargetAimTime >= TargetTimeout);
+	if (!Target || !Target->IsTargetEnabled() || bIsTargetStale)
+	{
+		if (Target && bIsTargetStale)
+		{
+			UE_LOG(LogSoakBot, Verbose, TEXT("The target %s stayed unhit for %.1f s, dropping it"), *Target->GetName(), TargetAimTime)
+			DroppedTarget = Target;
+		}
+
+		Target = FindNearestTarget();
+		CurrentTarget = Target;
+		TargetAimTime = 0.f;
+		if (!Target)
+		{
+			ClearFocus(EAIFocusPriority::Gameplay);
+			return;
+		}
+	}
+
+	// the focus turns the control rotation towards the target, the pitch included, the bot fires once the aim is close enough
+	SetFocalPoint(Target->GetActorLocation());
+
+	FireCooldown -= DeltaTime;
+	if (FireCooldown > 0.f)
+	{
+		return;
+	}
+
+	// the aim is measured from the view location, the control rotation is computed from it too
+	const FVector ViewLocation = BotCharacter->GetPawnViewLocation();
+	const FVector ToTarget = (Target->GetActorLocation() - ViewLocation).GetSafeNormal();
+	const FVector AimDirection = GetControlRotation().Vector();
+	if (FVector::DotProduct(ToTarget, AimDirection) < FMath::Cos(FMath::DegreesToRadians(AimToleranceDegrees)))
+	{
+		return;
+	}
+
+	// the shot takes the first target along the aim, the bot switches to it if it is in front of the current one
+	ASphereTarget* TargetInLine = FindTargetInLineOfFire(FVector::Dist(ViewLocation, Target->GetActorLocation()));
+	if (!TargetInLine)
+	{
+		return;
+	}
+	if (TargetInLine != Target)
+	{
+		CurrentTarget = TargetInLine;
+		TargetAimTime = 0.f;
+	}
+
+	BotCharacter->OnFire();
+	FireCooldown = 1.f / FireRate;
+}
+
+// turns the control rotation towards the focal point, unlike the base controller it keeps the pitch for the targets that are not pawns
+void ASphereHordeBotController::UpdateControlRotation(float DeltaTime, bool bUpdatePawn)
+{
+	APawn* const MyPawn = GetPawn();
+	const FVector FocalPoint = GetFocalPoint();
+	if (!MyPawn || !FAISystem::IsValidLocation(FocalPoint))
+	{
+		Super::UpdateControlRotation(DeltaTime, bUpdatePawn);
+		return;
+	}
+
+	const FRotator NewControlRotation = (FocalPoint - MyPawn->GetPawnViewLocation()).Rotation();
+	SetControlRotation(NewControlRotation);
+
+	if (bUpdatePawn && !MyPawn->GetActorRotation().Equals(NewControlRotation, 1e-3f))
+	{
+		MyPawn->FaceRotation(NewControlRotation, DeltaTime);
+	}
+}
+
+// finds the nearest enabled in range target, the dropped target is skipped
+ASphereTarget* ASphereHordeBotController::FindNearestTarget() const
+{
+	ASphereHordeGameMode* GameMode = GetWorld()->GetAuthGameMode<ASphereHordeGameMode>();
+	const ARadialActorsSpawner* Spawner = GameMode ? GameMode->GetSpheresSpawner() : nullptr;
+	if (!Spawner)
+	{
+		return nullptr;
+	}
+
+	// the spatial index skips the hidden targets of the prepared wave
+	const FSphereHordeTargetIndex& TargetIndex = Spawner->GetTargetIndex();
+	TArray<FSphereTargetHandle> NearestHandles;
+	const ASphereTarget* const IgnoredTarget = DroppedTarget.Get();
+	TargetIndex.QueryNearest(BotCharacter->GetActorLocation(), 1, NearestHandles, [IgnoredTarget](const ASphereTarget* Target) { return Target->IsInRange() && Target != IgnoredTarget; });
+
+	return (NearestHandles.Num() > 0) ? TargetIndex.Resolve(NearestHandles[0]) : nullptr;
+}
+
+// finds the first target along the aim within the distance
+ASphereTarget* ASphereHordeBotController::FindTargetInLineOfFire(float MaxDistance) const
+{
+	ASphereHordeGameMode* GameMode = GetWorld()->GetAuthGameMode<ASphereHordeGameMode>();
+	const ARadialActorsSpawner* Spawner = GameMode ? GameMode->GetSpheresSpawner() : nullptr;
+	if (!Spawner)
+	{
+		return nullptr;
+	}
+
+	// the hidden targets of the prepared wave do not block the shot, the ray query skips them
+	const FSphereHordeTargetIndex& TargetIndex = Spawner->GetTargetIndex();
+	FSphereTargetHandleArray HitHandles;
+	TargetIndex.QueryRay(BotCharacter->GetPawnViewLocation(), GetControlRotation().Vector(), MaxDistance, HitHandles, 1);
+
+	return (HitHandles.Num() > 0) ? TargetIndex.Resolve(HitHandles[0]) : nullptr;
+}
+
+// logs the wave timings and the memory on the wave change
+void ASphereHordeBotController::OnScoreChanged(int32 DestroyedSpheres, int32 CurrentWaveNumber)
+{
+	if (CurrentWaveNumber == LoggedWaveNumber)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+
+	float WaveSpawnMs = 0.f;
+	int32 LiveTargets = 0;
+	ASphereHordeGameMode* GameMode = GetWorld()->GetAuthGameMode<ASphereHordeGameMode>();
+	if (GameMode)
+	{
+		LiveTargets = GameMode->GetLiveTargetsNumber();
+		if (const ARadialActorsSpawner* Spawner = GameMode->GetSpheresSpawner())
+		{
+			WaveSpawnMs = Spawner->GetLastWaveSpawnMs();
+		}
+	}
+
+	UE_LOG(LogSoakBot, Log, TEXT("Wave %d finished in %.2f s, wave %d spawned in %.2f ms, score %d, live targets %d, used memory %.1f MB, objects %d"),
+		LoggedWaveNumber, Now - WaveStartTime, CurrentWaveNumber, WaveSpawnMs, DestroyedSpheres, LiveTargets,
+		MemoryStats.UsedPhysical / (1024.0 * 1024.0), GUObjectArray.GetObjectArrayNumMinusAvailable())
+
+	LoggedWaveNumber = CurrentWaveNumber;
+	WaveStartTime = Now;
+
+	if (MaxWave > 0 && CurrentWaveNumber >= MaxWave)
+	{
+		FinishSoak(TEXT("target wave reached"));
+	}
+}
+
+// logs the summary and quits the game
+void ASphereHordeBotController::FinishSoak(const TCHAR* Reason)
+{
+	bIsFinished = true;
+	ClearFocus(EAIFocusPriority::Gameplay);
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	UE_LOG(LogSoakBot, Log, TEXT("Soak finished, %s: wave %d after %.0f s, peak used memory %.1f MB"),
+		Reason, LoggedWaveNumber, FPlatformTime::Seconds() - SoakStartTime, MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0))
+
+	FPlatformMisc::RequestExit(false);
+}
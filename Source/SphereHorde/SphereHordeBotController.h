@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "SphereHordeBotController.generated.h"
+
+class ASphereTarget;
+class ASphereHordeCharacter;
+
+/*
+	define the soak test bot, it possesses the character, aims at the nearest in range target and fires at a fixed rate,
+	it logs the timings and the memory on every wave and quits the game at the target wave or after the time limit
+
+	the bot is enabled with -SoakBot, the settings can be overridden from the command line:
+	-SoakFireRate=<shots per second> -SoakMaxWave=<wave> -SoakMaxSeconds=<seconds> -SoakTargetTimeout=<seconds>
+*/
+
+UCLASS()
+class SPHEREHORDE_API ASphereHordeBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ASphereHordeBotController();
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	// checks if the soak bot is requested from the command line
+	static bool	IsSoakBotRequested();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void OnPossess(APawn* InPawn) override;
+
+	// turns the control rotation towards the focal point, the pitch included
+	virtual void UpdateControlRotation(float DeltaTime, bool bUpdatePawn = true) override;
+
+	// the number of the shots per second
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.1"), Category = "Soak")
+	float	FireRate = 4.f;
+
+	// the wave at which the bot stops the game, 0 for no limit
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0"), Category = "Soak")
+	int32	MaxWave = 0;
+
+	// the time after which the bot stops the game, in seconds, 0 for no limit
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0"), Category = "Soak")
+	float	MaxSeconds = 0.f;
+
+	// the angle between the aim and the target below which the bot fires, in degrees
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.1", ClampMax = "45.0"), Category = "Soak")
+	float	AimToleranceDegrees = 2.f;
+
+	// the time after which the bot drops the target it could not hit, in seconds, 0 for no limit
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0"), Category = "Soak")
+	float	TargetTimeout = 5.f;
+
+private:
+	// the possessed character
+	UPROPERTY()
+	ASphereHordeCharacter*	BotCharacter;
+
+	// the target the bot aims at
+	TWeakObjectPtr<ASphereTarget>	CurrentTarget;
+
+	// the target dropped last for staying unhit, it is skipped by the next search
+	TWeakObjectPtr<ASphereTarget>	DroppedTarget;
+
+	// the time the bot has been aiming at the current target
+	float	TargetAimTime;
+
+	// the time left before the next shot
+	float	FireCooldown;
+
+	// the time the soak test and the current wave started at
+	double	SoakStartTime;
+	double	WaveStartTime;
+
+	// the wave the bot has logged last
+	int32	LoggedWaveNumber;
+
+	// true once the bot has requested the game to quit
+	bool	bIsFinished;
+
+	// finds the nearest enabled in range target, the dropped target is skipped
+	ASphereTarget*	FindNearestTarget() const;
+
+	// finds the first target along the aim within the distance
+	ASphereTarget*	FindTargetInLineOfFire(float MaxDistance) const;
+
+	// logs the wave timings and the memory on the wave change
+	void	OnScoreChanged(int32 DestroyedSpheres, int32 CurrentWaveNumber);
+
+	// logs the summary and quits the game
+	void	FinishSoak(const TCHAR* Reason);
+};
@@ -2,12 +2,15 @@
 
 #include "SphereHordeCharacter.h"
 #include "SphereHordeProjectile.h"
+#include "SphereHordeGameMode.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/AnimMontage.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
 #include "GameFramework/InputSettings.h"
 #include "Kismet/GameplayStatics.h"
+#include "Sound/SoundBase.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 
@@ -73,12 +76,12 @@ void ASphereHordeCharacter::SetupPlayerInputComponent(class UInputComponent* Pla
 	// set up gameplay key bindings
 	check(PlayerInputComponent);
 
-	// Bind jump events
-	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &ACharacter::Jump);
-	PlayerInputComponent->BindAction("Jump", IE_Released, this, &ACharacter::StopJumping);
+	// Bind jump events, all the bound input goes through the input log, so it can be recorded and replayed
+	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &ASphereHordeCharacter::OnJumpPressed);
+	PlayerInputComponent->BindAction("Jump", IE_Released, this, &ASphereHordeCharacter::OnJumpReleased);
 
 	// Bind fire event
-	PlayerInputComponent->BindAction("Fire", IE_Pressed, this, &ASphereHordeCharacter::OnFire);
+	PlayerInputComponent->BindAction("Fire", IE_Pressed, this, &ASphereHordeCharacter::OnFireInput);
 
 	// Bind movement events
 	PlayerInputComponent->BindAxis("MoveForward", this, &ASphereHordeCharacter::MoveForward);
@@ -87,53 +90,85 @@ void ASphereHordeCharacter::SetupPlayerInputComponent(class UInputComponent* Pla
 	// We have 2 versions of the rotation bindings to handle different kinds of devices differently
 	// "turn" handles devices that provide an absolute delta, such as a mouse.
 	// "turnrate" is for devices that we choose to treat as a rate of change, such as an analog joystick
-	PlayerInputComponent->BindAxis("Turn", this, &APawn::AddControllerYawInput);
+	PlayerInputComponent->BindAxis("Turn", this, &ASphereHordeCharacter::Turn);
 	PlayerInputComponent->BindAxis("TurnRate", this, &ASphereHordeCharacter::TurnAtRate);
-	PlayerInputComponent->BindAxis("LookUp", this, &APawn::AddControllerPitchInput);
+	PlayerInputComponent->BindAxis("LookUp", this, &ASphereHordeCharacter::LookUp);
 	PlayerInputComponent->BindAxis("LookUpRate", this, &ASphereHordeCharacter::LookUpAtRate);
 }
 
-void ASphereHordeCharacter::OnFire()
+void ASphereHordeCharacter::GetAssetsToPreload(TArray<FSoftObjectPath>& OutAssets) const
 {
-	// try and fire a projectile
-	if (ProjectileClass != nullptr)
+	if (!ProjectileClass.IsNull())
 	{
-		UWorld* const World = GetWorld();
-		if (World != nullptr)
-		{
-			const FRotator SpawnRotation = GetControlRotation();
-			// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
-			const FVector SpawnLocation = ((FP_MuzzleLocation != nullptr) ? FP_MuzzleLocation->GetComponentLocation() : GetActorLocation()) + SpawnRotation.RotateVector(GunOffset);
-
-			//Set Spawn Collision Handling Override
-			FActorSpawnParameters ActorSpawnParams;
-			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+		OutAssets.Add(ProjectileClass.ToSoftObjectPath());
+	}
+	if (!FireSound.IsNull())
+	{
+		OutAssets.Add(FireSound.ToSoftObjectPath());
+	}
+	if (!FireAnimation.IsNull())
+	{
+		OutAssets.Add(FireAnimation.ToSoftObjectPath());
+	}
+}
 
-			// spawn the projectile at the muzzle
-			World->SpawnActor<ASphereHordeProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
-		}
+void ASphereHordeCharacter::OnFire()
+{
+	// the projectile is spawned on the server and replicated, the effects are played locally
+	if (HasAuthority())
+	{
+		SpawnProjectile();
+	}
+	else
+	{
+		ServerFire();
 	}
 
-	// try and play the sound if specified
-	if (FireSound != nullptr)
+	// try and play the sound if specified and loaded
+	if (USoundBase* const LoadedFireSound = FireSound.Get())
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
+		UGameplayStatics::PlaySoundAtLocation(this, LoadedFireSound, GetActorLocation());
 	}
 
-	// try and play a firing animation if specified
-	if (FireAnimation != nullptr)
+	// try and play a firing animation if specified and loaded
+	if (UAnimMontage* const LoadedFireAnimation = FireAnimation.Get())
 	{
 		// Get the animation object for the arms mesh
 		UAnimInstance* AnimInstance = Mesh1P->GetAnimInstance();
 		if (AnimInstance != nullptr)
 		{
-			AnimInstance->Montage_Play(FireAnimation, 1.f);
+			AnimInstance->Montage_Play(LoadedFireAnimation, 1.f);
 		}
 	}
 }
 
+void ASphereHordeCharacter::OnFireInput()
+{
+	if (CaptureInputAction(ESphereHordeInputAction::Fire))
+	{
+		OnFire();
+	}
+}
+
+void ASphereHordeCharacter::OnJumpPressed()
+{
+	if (CaptureInputAction(ESphereHordeInputAction::JumpPressed))
+	{
+		Jump();
+	}
+}
+
+void ASphereHordeCharacter::OnJumpReleased()
+{
+	if (CaptureInputAction(ESphereHordeInputAction::JumpReleased))
+	{
+		StopJumping();
+	}
+}
+
 void ASphereHordeCharacter::MoveForward(float Value)
 {
+	Value = CaptureInputAxis(&FSphereHordeInputFrame::MoveForward, Value);
 	if (Value != 0.0f)
 	{
 		// add movement in that direction
@@ -143,6 +178,7 @@ void ASphereHordeCharacter::MoveForward(float Value)
 
 void ASphereHordeCharacter::MoveRight(float Value)
 {
+	Value = CaptureInputAxis(&FSphereHordeInputFrame::MoveRight, Value);
 	if (Value != 0.0f)
 	{
 		// add movement in that direction
@@ -152,12 +188,138 @@ void ASphereHordeCharacter::MoveRight(float Value)
 
 void ASphereHordeCharacter::TurnAtRate(float Rate)
 {
+	Rate = CaptureInputAxis(&FSphereHordeInputFrame::TurnRate, Rate);
 	// calculate delta for this frame from the rate information
 	AddControllerYawInput(Rate * BaseTurnRate * GetWorld()->GetDeltaSeconds());
 }
 
 void ASphereHordeCharacter::LookUpAtRate(float Rate)
 {
+	Rate = CaptureInputAxis(&FSphereHordeInputFrame::LookUpRate, Rate);
 	// calculate delta for this frame from the rate information
 	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
-}
\ No newline at end of file
+}
+
+void ASphereHordeCharacter::Turn(float Value)
+{
+	AddControllerYawInput(CaptureInputAxis(&FSphereHordeInputFrame::Turn, Value));
+}
+
+void ASphereHordeCharacter::LookUp(float Value)
+{
+	AddControllerPitchInput(CaptureInputAxis(&FSphereHordeInputFrame::LookUp, Value));
+}
+
+float ASphereHordeCharacter::CaptureInputAxis(float FSphereHordeInputFrame::* Axis, float Value)
+{
+	ASphereHordeGameMode* GameMode = GetWorld()->GetAuthGameMode<ASphereHordeGameMode>();
+	if (!GameMode)
+	{
+		return Value;
+	}
+
+	switch (GameMode->GetInputLogMode())
+	{
+	case ESphereHordeInputLogMode::Record:
+		if (FSphereHordeInputFrame* RecordedFrame = GameMode->GetRecordedInputFrame())
+		{
+			RecordedFrame->*Axis = Value;
+		}
+		return Value;
+
+	case ESphereHordeInputLogMode::Replay:
+	{
+		// the axes are dispatched every frame, so the first of them plays the actions of the frame,
+		// the actions are dispatched before the axes, as in the recorded game
+		bool bIsNewFrame = false;
+		const FSphereHordeInputFrame* ReplayedFrame = GameMode->GetReplayedInputFrame(bIsNewFrame);
+		if (!ReplayedFrame)
+		{
+			return Value;
+		}
+
+		if (bIsNewFrame)
+		{
+			if (EnumHasAnyFlags(ReplayedFrame->Actions, ESphereHordeInputAction::JumpPressed))
+			{
+				Jump();
+			}
+			if (EnumHasAnyFlags(ReplayedFrame->Actions, ESphereHordeInputAction::JumpReleased))
+			{
+				StopJumping();
+			}
+			if (EnumHasAnyFlags(ReplayedFrame->Actions, ESphereHordeInputAction::Fire))
+			{
+				OnFire();
+			}
+		}
+		return ReplayedFrame->*Axis;
+	}
+
+	default:
+		return Value;
+	}
+}
+
+bool ASphereHordeCharacter::CaptureInputAction(ESphereHordeInputAction Action)
+{
+	ASphereHordeGameMode* GameMode = GetWorld()->GetAuthGameMode<ASphereHordeGameMode>();
+	if (!GameMode)
+	{
+		return true;
+	}
+
+	switch (GameMode->GetInputLogMode())
+	{
+	case ESphereHordeInputLogMode::Record:
+		if (FSphereHordeInputFrame* RecordedFrame = GameMode->GetRecordedInputFrame())
+		{
+			RecordedFrame->Actions |= Action;
+		}
+		return true;
+
+	case ESphereHordeInputLogMode::Replay:
+		// the live actions are ignored, the replayed ones are played with the axes of their frame
+		return false;
+
+	default:
+		return true;
+	}
+}
+
+void ASphereHordeCharacter::ServerFire_Implementation()
+{
+	SpawnProjectile();
+}
+
+void ASphereHordeCharacter::SpawnProjectile()
+{
+	// the projectile is preloaded by the game mode, load it here only if the preload is not finished yet
+	UClass* const LoadedProjectileClass = ProjectileClass.IsPending() ? ProjectileClass.LoadSynchronous() : ProjectileClass.Get();
+
+	// try and fire a projectile
+	if (LoadedProjectileClass != nullptr)
+	{
+		UWorld* const World = GetWorld();
+		if (World != nullptr)
+		{
+			const FRotator SpawnRotation = GetControlRotation();
+			// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
+			const FVector SpawnLocation = ((FP_MuzzleLocation != nullptr) ? FP_MuzzleLocation->GetComponentLocation() : GetActorLocation()) + SpawnRotation.RotateVector(GunOffset);
+
+			//Set Spawn Collision Handling Override
+			FActorSpawnParameters ActorSpawnParams;
+			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+			// spawn the projectile at the muzzle
+			World->SpawnActor<ASphereHordeProjectile>(LoadedProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+
+			// record the shot to the telemetry
+			ASphereHordeGameMode* GameMode = World->GetAuthGameMode<ASphereHordeGameMode>();
+			if (GameMode)
+			{
+				GameMode->RecordTelemetry(ESphereHordeTelemetryEvent::Shot, SpawnLocation, GameMode->GetCurrentWaveNumber());
+			}
+		}
+	}
+}
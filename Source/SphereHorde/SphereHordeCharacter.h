@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "SphereHordeInputLog.h"
 #include "SphereHordeCharacter.generated.h"
 
 class UInputComponent;
@@ -62,23 +63,38 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
 	FVector GunOffset;
 
-	/** Projectile class to spawn */
+	/** Projectile class to spawn, preloaded asynchronously by the game mode */
 	UPROPERTY(EditDefaultsOnly, Category=Projectile)
-	TSubclassOf<class ASphereHordeProjectile> ProjectileClass;
+	TSoftClassPtr<class ASphereHordeProjectile> ProjectileClass;
 
-	/** Sound to play each time we fire */
+	/** Sound to play each time we fire, preloaded asynchronously by the game mode */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
-	USoundBase* FireSound;
+	TSoftObjectPtr<USoundBase> FireSound;
 
-	/** AnimMontage to play each time we fire */
+	/** AnimMontage to play each time we fire, preloaded asynchronously by the game mode */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
-	UAnimMontage* FireAnimation;
+	TSoftObjectPtr<UAnimMontage> FireAnimation;
 
-protected:
-	
-	/** Fires a projectile. */
+	/** Collects the softly referenced assets that should be loaded before the first shot */
+	void GetAssetsToPreload(TArray<FSoftObjectPath>& OutAssets) const;
+
+	/** Fires a projectile, bound to the Fire input and called by the soak bot */
 	void OnFire();
 
+protected:
+
+	/** Spawns the projectile, called on the server */
+	void SpawnProjectile();
+
+	/** Asks the server to spawn the projectile */
+	UFUNCTION(Server, Reliable)
+	void ServerFire();
+
+	/** Handles the Fire and Jump actions, they are recorded or replaced by the replayed ones */
+	void OnFireInput();
+	void OnJumpPressed();
+	void OnJumpReleased();
+
 	/** Handles moving forward/backward */
 	void MoveForward(float Val);
 
@@ -97,6 +113,23 @@ protected:
 	 */
 	void LookUpAtRate(float Rate);
 
+	/** Handles the absolute turn and look up deltas, such as a mouse */
+	void Turn(float Val);
+	void LookUp(float Val);
+
+	/**
+	 * Records the axis value into the input log, or replaces it with the replayed one.
+	 * The first call in a replayed frame also plays the actions recorded in it.
+	 * @return	the value to apply
+	 */
+	float CaptureInputAxis(float FSphereHordeInputFrame::* Axis, float Value);
+
+	/**
+	 * Records the action into the input log.
+	 * @return	false if the live action is to be ignored, while the input is replayed
+	 */
+	bool CaptureInputAction(ESphereHordeInputAction Action);
+
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
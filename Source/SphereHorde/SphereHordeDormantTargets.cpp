@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeDormantTargets.h"
+
+FSphereHordeDormantTargets::FSphereHordeDormantTargets()
+{
+	CellSize = 500.f;
+}
+
+// sets the size of the cells, drops all the records
+void	FSphereHordeDormantTargets::Initialize(float InCellSize)
+{
+	Reset();
+	CellSize = FMath::Max(InCellSize, 1.f);
+}
+
+// adds the record of a target
+void	FSphereHordeDormantTargets::Add(const FSphereTargetRecord& Record)
+{
+	const int32 RecordId = Records.Add(Record);
+	const FIntVector Cell = GetCell(Record.Location);
+	RecordCells.Add(Cell);
+	Cells.FindOrAdd(Cell).Add(RecordId);
+}
+
+// removes all the records
+void	FSphereHordeDormantTargets::Reset()
+{
+	Records.Reset();
+	RecordCells.Reset();
+	Cells.Reset();
+}
+
+// get the number of the records
+int32	FSphereHordeDormantTargets::Num() const
+{
+	return Records.Num();
+}
+
+// get all the records
+const TArray<FSphereTargetRecord>&	FSphereHordeDormantTargets::GetRecords() const
+{
+	return Records;
+}
+
+// checks if any record has its center closer than the distance to the location
+bool	FSphereHordeDormantTargets::IsAnyCenterWithin(const FVector& Location, float Distance) const
+{
+	if (Records.Num() == 0)
+	{
+		return false;
+	}
+
+	const float DistanceSquared = FMath::Square(Distance);
+	const FIntVector MinCell = GetCell(Location - FVector(Distance));
+	const FIntVector MaxCell = GetCell(Location + FVector(Distance));
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+			{
+				const TArray<int32>* CellRecords = Cells.Find(FIntVector(X, Y, Z));
+				if (!CellRecords)
+				{
+					continue;
+				}
+
+				for (int32 RecordId : *CellRecords)
+				{
+					if (FVector::DistSquared(Records[RecordId].Location, Location) < DistanceSquared)
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+// moves up to MaxRecordsNb records within Radius of Center and of the waves up to MaxWaveId to OutRecords
+void	FSphereHordeDormantTargets::TakeWithin(const FVector& Center, float Radius, int32 MaxWaveId, int32 MaxRecordsNb, TArray<FSphereTargetRecord>& OutRecords)
+{
+	if (Records.Num() == 0 || MaxRecordsNb <= 0)
+	{
+		return;
+	}
+
+	const float RadiusSquared = FMath::Square(Radius);
+	const FIntVector MinCell = GetCell(Center - FVector(Radius));
+	const FIntVector MaxCell = GetCell(Center + FVector(Radius));
+
+	TArray<int32, TInlineAllocator<64>> TakenRecordIds;
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z && TakenRecordIds.Num() < MaxRecordsNb; Z++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y && TakenRecordIds.Num() < MaxRecordsNb; Y++)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X && TakenRecordIds.Num() < MaxRecordsNb; X++)
+			{
+				const TArray<int32>* CellRecords = Cells.Find(FIntVector(X, Y, Z));
+				if (!CellRecords)
+				{
+					continue;
+				}
+
+				for (int32 RecordId : *CellRecords)
+				{
+					const FSphereTargetRecord& Record = Records[RecordId];
+					if (Record.WaveId <= MaxWaveId && FVector::DistSquared(Record.Location, Center) <= RadiusSquared)
+					{
+						TakenRecordIds.Add(RecordId);
+						if (TakenRecordIds.Num() == MaxRecordsNb)
+						{
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// the records are removed from the highest id, so the ids still to be removed are not moved by the swaps
+	TakenRecordIds.Sort(TGreater<int32>());
+	for (int32 RecordId : TakenRecordIds)
+	{
+		OutRecords.Add(Records[RecordId]);
+		RemoveAtSwap(RecordId);
+	}
+}
+
+// moves all the records of the wave to OutRecords
+void	FSphereHordeDormantTargets::TakeWave(int32 WaveId, TArray<FSphereTargetRecord>& OutRecords)
+{
+	// the records are visited from the last one, so the swaps only move the records visited already
+	for (int32 RecordId = Records.Num() - 1; RecordId >= 0; RecordId--)
+	{
+		if (Records[RecordId].WaveId == WaveId)
+		{
+			OutRecords.Add(Records[RecordId]);
+			RemoveAtSwap(RecordId);
+		}
+	}
+}
+
+// get the cell the point is in
+FIntVector	FSphereHordeDormantTargets::GetCell(const FVector& Point) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Point.X / CellSize),
+		FMath::FloorToInt(Point.Y / CellSize),
+		FMath::FloorToInt(Point.Z / CellSize));
+}
+
+// removes the record, the last record takes its id
+void	FSphereHordeDormantTargets::RemoveAtSwap(int32 RecordId)
+{
+	const FIntVector Cell = RecordCells[RecordId];
+	TArray<int32>& CellRecords = Cells.FindChecked(Cell);
+	CellRecords.RemoveSingleSwap(RecordId, false);
+	if (CellRecords.Num() == 0)
+	{
+		Cells.Remove(Cell);
+	}
+
+	// the last record moves to the removed id, its cell lists it by the new id
+	const int32 LastRecordId = Records.Num() - 1;
+	if (RecordId != LastRecordId)
+	{
+		TArray<int32>& LastCellRecords = Cells.FindChecked(RecordCells[LastRecordId]);
+		LastCellRecords[LastCellRecords.IndexOfByKey(LastRecordId)] = RecordId;
+	}
+
+	Records.RemoveAtSwap(RecordId, 1, false);
+	RecordCells.RemoveAtSwap(RecordId, 1, false);
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SphereHordeSnapshot.h"
+
+/*
+	define the store of the dormant targets, the targets far from the pawn that exist as the records only, without the actors,
+	the records are hashed by the cell of their location, so the spawner keeps the new targets apart from them
+	and takes the ones the pawn comes close to without visiting the whole horde
+
+	the records of the prepared wave are stored too, they are not taken until their wave is started
+*/
+
+class FSphereHordeDormantTargets
+{
+public:
+	FSphereHordeDormantTargets();
+
+	// sets the size of the cells, drops all the records
+	void	Initialize(float InCellSize);
+
+	// adds the record of a target
+	void	Add(const FSphereTargetRecord& Record);
+
+	// removes all the records
+	void	Reset();
+
+	// get the number of the records
+	int32	Num() const;
+
+	// get all the records, in no particular order
+	const TArray<FSphereTargetRecord>&	GetRecords() const;
+
+	// checks if any record has its center closer than the distance to the location
+	bool	IsAnyCenterWithin(const FVector& Location, float Distance) const;
+
+	// moves up to MaxRecordsNb records within Radius of Center and of the waves up to MaxWaveId to OutRecords
+	void	TakeWithin(const FVector& Center, float Radius, int32 MaxWaveId, int32 MaxRecordsNb, TArray<FSphereTargetRecord>& OutRecords);
+
+	// moves all the records of the wave to OutRecords
+	void	TakeWave(int32 WaveId, TArray<FSphereTargetRecord>& OutRecords);
+
+private:
+	// the records and the cells they are listed in, the index in the arrays is the id of the record
+	TArray<FSphereTargetRecord>	Records;
+	TArray<FIntVector>			RecordCells;
+
+	// the ids of the records listed in each non-empty cell
+	TMap<FIntVector, TArray<int32>>	Cells;
+
+	// the size of a cell, in world units
+	float	CellSize;
+
+	// get the cell the point is in
+	FIntVector	GetCell(const FVector& Point) const;
+
+	// removes the record, the last record takes its id
+	void	RemoveAtSwap(int32 RecordId);
+};
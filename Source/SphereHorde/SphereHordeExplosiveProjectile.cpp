@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeExplosiveProjectile.h"
+#include "SphereHordeGameMode.h"
+#include "SphereHordeMovingHorde.h"
+#include "RadialActorsSpawner.h"
+#include "SphereTarget.h"
+#include "Kismet/GameplayStatics.h"
+
+ASphereHordeExplosiveProjectile::ASphereHordeExplosiveProjectile()
+{
+	// the blast is resolved on the first hit, so the projectile does not bounce
+	GetProjectileMovement()->bShouldBounce = false;
+}
+
+void ASphereHordeExplosiveProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	// the targets exist on the server only
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	// the projectile is destroyed once the blast is resolved, so the blast still has its world and its owner
+	Explode(Hit.ImpactPoint, OtherActor);
+	Destroy();
+}
+
+// destroys the targets within the blast radius of Center
+void ASphereHordeExplosiveProjectile::Explode(const FVector& Center, AActor* OtherActor)
+{
+	ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	ARadialActorsSpawner* Spawner = GameMode ? GameMode->GetSpheresSpawner() : nullptr;
+	if (!Spawner)
+	{
+		// without the spawner only the target that was hit directly is destroyed
+		if (ASphereTarget* SphereTargetHit = Cast<ASphereTarget>(OtherActor))
+		{
+			SphereTargetHit->PlayDeathEffectsAndDestroy();
+		}
+		return;
+	}
+
+	// one query of the spatial index instead of the overlap test against the physics scene,
+	// the hidden targets of the prepared wave are not caught by the blast
+	FSphereTargetHandleArray BlastHandles;
+	TArray<ASphereTarget*, TInlineAllocator<64>> BlastTargets;
+	const FSphereHordeTargetIndex& TargetIndex = Spawner->GetTargetIndex();
+	TargetIndex.QueryRadius(Center, BlastRadius, BlastHandles);
+	for (const FSphereTargetHandle& Handle : BlastHandles)
+	{
+		if (ASphereTarget* TargetSphere = TargetIndex.Resolve(Handle))
+		{
+			BlastTargets.Add(TargetSphere);
+		}
+	}
+
+	// the target that was hit directly is destroyed even if its center is out of the blast radius
+	ASphereTarget* SphereTargetHit = Cast<ASphereTarget>(OtherActor);
+	if (SphereTargetHit && SphereTargetHit->IsTargetEnabled())
+	{
+		BlastTargets.AddUnique(SphereTargetHit);
+	}
+
+	const int32 VfxNb = FMath::Min(BlastTargets.Num(), MaxVfxPerBlast);
+	for (int32 TargetId = 0; TargetId < VfxNb; TargetId++)
+	{
+		BlastTargets[TargetId]->PlayDeathEffects();
+	}
+
+	FSphereTargetKillArray BlastKills;
+	if (ASphereHordeMovingHorde* MovingHorde = Spawner->GetMovingHorde())
+	{
+		MovingHorde->KillTargetsInRadius(Center, BlastRadius, MaxVfxPerBlast - VfxNb, BlastKills);
+	}
+
+	// the kills are counted as one batch, so the wave is started once even if the blast finishes it several times over
+	if (BlastTargets.Num() > 0 || BlastKills.Num() > 0)
+	{
+		GameMode->UpdatedNubmerOfDestroyedSpheres(BlastTargets, BlastKills);
+	}
+}
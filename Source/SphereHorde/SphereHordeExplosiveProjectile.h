@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SphereHordeProjectile.h"
+#include "SphereTarget.h"
+#include "SphereHordeTargetIndex.h"
+#include "SphereHordeExplosiveProjectile.generated.h"
+
+/*
+	the projectile that destroys all the targets within the blast radius of its impact
+	the targets are found with one query of the spatial index of the spawner and one pass over the moving horde,
+	and they are counted in the game mode as one batch, so the wave is checked and the score is sent once per blast
+
+	Parameters to set:
+	1. radius of the blast
+	2. max number of the destruction vfx played per blast
+*/
+
+UCLASS(config=Game)
+class ASphereHordeExplosiveProjectile : public ASphereHordeProjectile
+{
+	GENERATED_BODY()
+
+public:
+	ASphereHordeExplosiveProjectile();
+
+	/** called when projectile hits something */
+	virtual void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit) override;
+
+protected:
+	// the radius around the impact point the targets are destroyed within
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0"), Category = "Blast")
+	float	BlastRadius = 400.f;
+
+	// the max number of the destruction vfx played per blast, the rest of the targets are destroyed without vfx
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0"), Category = "Blast")
+	int32	MaxVfxPerBlast = 8;
+
+private:
+	// destroys the targets within the blast radius of Center
+	void	Explode(const FVector& Center, AActor* OtherActor);
+};
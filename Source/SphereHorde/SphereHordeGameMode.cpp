@@ -6,6 +6,14 @@
 #include "RadialActorsSpawner.h"
 #include "SphereTarget.h"
 #include "UObject/ConstructorHelpers.h"
+#include "Engine/AssetManager.h"
+#include "SphereHordeSnapshot.h"
+#include "SphereHordeReplicatedHorde.h"
+#include "SphereHordeBotController.h"
+#include "Misc/Paths.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
 
 ASphereHordeGameMode::ASphereHordeGameMode()
 	: Super()
@@ -23,6 +31,18 @@ ASphereHordeGameMode::ASphereHordeGameMode()
 	// initialize the wave number
 	CurrentWaveNumber = 1;
 
+	// initialize the number of the placed targets
+	LiveTargets = 0;
+
+	// the soak bot is spawned only if it is requested from the command line
+	SoakBotClass = ASphereHordeBotController::StaticClass();
+	SoakBot = nullptr;
+
+	// the input is neither recorded nor replayed unless it is requested from the command line
+	InputLogMode = ESphereHordeInputLogMode::None;
+	InputFrameIndex = INDEX_NONE;
+	InputFrameCounter = 0;
+
 	// initialize the SpheresDistanceFromOrigin, that denotes the range from origin, within it the sphere should be counted as killed
 	// and get a point for its destruction
 	SpheresDistanceFromOrigin = 1500.f;
@@ -30,6 +50,15 @@ ASphereHordeGameMode::ASphereHordeGameMode()
 
 void ASphereHordeGameMode::BeginPlay()
 {
+	// the preload stage, the pawn assets are streamed here and the spawner streams the assets
+	// of the first wave before spawning it, so nothing is loaded synchronously on the first shot or kill
+	PreloadPawnAssets();
+
+	// the seed of the spawner comes from the replayed log, so the waves are placed the same way
+	const int32 SpawnSeed = SetupInputLog();
+
+	StartTelemetry();
+
 	// Get player pawn, if the player pawn if not nullptr we get its location
 	// to spawn a RadialActorsSpawner if RadialActorsSpawner is not nullptr
 	// initialize its ActorsNb and InnerRadiusNb
@@ -41,7 +70,8 @@ void ASphereHordeGameMode::BeginPlay()
 		{
 			UE_LOG(LogTemp, Warning, TEXT("FAILED to create CreatedSheresSpawner in SphereHordeGameMode"))
 		}
-		CreatedSpheresSpawner->Initialize(ActorsPerWave, DestroyedSpheresPerWave);
+		CreatedSpheresSpawner->Initialize(ActorsPerWave, DestroyedSpheresPerWave, SpheresDistanceFromOrigin);
+		CreatedSpheresSpawner->SetSpawnSeed(SpawnSeed, InputLogMode != ESphereHordeInputLogMode::None);
 		CreatedSpheresSpawner->FinishSpawning(ActorTransform);
 	}
 	else
@@ -50,24 +80,190 @@ void ASphereHordeGameMode::BeginPlay()
 	}
 }
 
+// the first player pawn is given to the soak bot if it is requested, the player controller stays as a spectator
+void ASphereHordeGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+
+	APawn* PlayerPawn = NewPlayer ? NewPlayer->GetPawn() : nullptr;
+	if (SoakBot || !SoakBotClass || !PlayerPawn || !ASphereHordeBotController::IsSoakBotRequested())
+	{
+		return;
+	}
+
+	SoakBot = GetWorld()->SpawnActor<ASphereHordeBotController>(SoakBotClass);
+	if (SoakBot)
+	{
+		NewPlayer->UnPossess();
+		SoakBot->Possess(PlayerPawn);
+	}
+}
+
+// get the pawn the horde is spawned around, the first player pawn or the pawn of the soak bot
+APawn* ASphereHordeGameMode::GetHordePawn() const
+{
+	if (SoakBot && SoakBot->GetPawn())
+	{
+		return SoakBot->GetPawn();
+	}
+
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	return PlayerController ? PlayerController->GetPawn() : nullptr;
+}
+
+// requests the asynchronous load of the softly referenced assets of the default pawn
+void ASphereHordeGameMode::PreloadPawnAssets()
+{
+	const ASphereHordeCharacter* PawnDefaults = DefaultPawnClass ? Cast<ASphereHordeCharacter>(DefaultPawnClass->GetDefaultObject()) : nullptr;
+	if (!PawnDefaults)
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> AssetsToLoad;
+	PawnDefaults->GetAssetsToPreload(AssetsToLoad);
+	if (AssetsToLoad.Num() > 0)
+	{
+		PawnAssetsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(AssetsToLoad);
+	}
+}
+
 // updates the number of destroyed spheres
 void	ASphereHordeGameMode::UpdatedNubmerOfDestroyedSpheres(ASphereTarget* TargetSphere)
 {
-	// check if the destroyed sphere is in range from the spawn origin
-	if (isInRangeFromTheOrigin(TargetSphere))
+	if (!TargetSphere)
+	{
+		return;
+	}
+
+	// the tags are read before the release, the pool may reset the target or destroy it once it is full
+	const FVector TargetLocation = TargetSphere->GetActorLocation();
+	const int32 WaveId = TargetSphere->GetWaveId();
+	const ESphereTargetShell Shell = TargetSphere->GetShell();
+
+	// return the target to the spawner so the next waves can reuse it
+	if (CreatedSpheresSpawner)
+	{
+		CreatedSpheresSpawner->ReleaseTarget(TargetSphere);
+	}
+	else
+	{
+		TargetSphere->Destroy();
+	}
+
+	UpdatedNubmerOfDestroyedSpheres(WaveId, Shell, TargetLocation);
+}
+
+// updates the number of destroyed spheres by the tags of the destroyed target
+void	ASphereHordeGameMode::UpdatedNubmerOfDestroyedSpheres(int32 WaveId, ESphereTargetShell Shell, const FVector& Location)
+{
+	const int32 PreviousDestroyedSpheres = DestroyedSpheres;
+	if (CountDestroyedSphere(WaveId, Shell, Location))
 	{
-		DestroyedSpheres++;
-		// check if we have destroyed needed number of the spheres to finish the wave
-		// and start new wave if the number is reached
-		if ((DestroyedSpheres % DestroyedSpheresPerWave) == 0 && (DestroyedSpheres != 0))
+		FinishDestroyedSpheresUpdate(PreviousDestroyedSpheres);
+	}
+}
+
+// updates the number of destroyed spheres for a batch of the destroyed targets and OtherKills, the targets are returned to the spawner
+void	ASphereHordeGameMode::UpdatedNubmerOfDestroyedSpheres(TArrayView<ASphereTarget* const> TargetSpheres, TArrayView<const FSphereTargetKill> OtherKills)
+{
+	FSphereTargetKillArray Kills(OtherKills.GetData(), OtherKills.Num());
+	for (ASphereTarget* TargetSphere : TargetSpheres)
+	{
+		if (!TargetSphere)
 		{
-			CurrentWaveNumber++;
-			if (CreatedSpheresSpawner)
-			{
-				CreatedSpheresSpawner->StartNewWave();
-			}
+			continue;
+		}
+
+		Kills.Add({ TargetSphere->GetActorLocation(), TargetSphere->GetWaveId(), TargetSphere->GetShell() });
+		if (CreatedSpheresSpawner)
+		{
+			CreatedSpheresSpawner->ReleaseTarget(TargetSphere);
+		}
+		else
+		{
+			TargetSphere->Destroy();
 		}
 	}
+
+	UpdatedNubmerOfDestroyedSpheres(Kills);
+}
+
+// updates the number of destroyed spheres for a batch of the destroyed targets by their tags,
+// the wave is checked and the score is sent once for the whole batch
+void	ASphereHordeGameMode::UpdatedNubmerOfDestroyedSpheres(TArrayView<const FSphereTargetKill> Kills)
+{
+	const int32 PreviousDestroyedSpheres = DestroyedSpheres;
+	bool bIsAnyCounted = false;
+	for (const FSphereTargetKill& Kill : Kills)
+	{
+		bIsAnyCounted |= CountDestroyedSphere(Kill.WaveId, Kill.Shell, Kill.Location);
+	}
+
+	if (bIsAnyCounted)
+	{
+		FinishDestroyedSpheresUpdate(PreviousDestroyedSpheres);
+	}
+}
+
+// counts the destroyed target, returns true if it is counted for the next wave
+bool	ASphereHordeGameMode::CountDestroyedSphere(int32 WaveId, ESphereTargetShell Shell, const FVector& Location)
+{
+	LiveTargets = FMath::Max(LiveTargets - 1, 0);
+	RecordTelemetry(ESphereHordeTelemetryEvent::Kill, Location, WaveId, (Shell == ESphereTargetShell::Inner) ? 1.f : 0.f);
+
+	// only the targets tagged as in range on spawn are counted
+	if (Shell != ESphereTargetShell::Inner)
+	{
+		return false;
+	}
+
+	// the target is not counted by its wave anymore
+	if (int32* RemainingTargets = RemainingInRangeTargetsPerWave.Find(WaveId))
+	{
+		*RemainingTargets = FMath::Max(*RemainingTargets - 1, 0);
+	}
+
+	DestroyedSpheres++;
+	return true;
+}
+
+// checks the wave once for the kills counted since PreviousDestroyedSpheres and sends the score,
+// a batch that crosses several thresholds starts one wave, so StartNewWave is never called twice for one batch
+void	ASphereHordeGameMode::FinishDestroyedSpheresUpdate(int32 PreviousDestroyedSpheres)
+{
+	// check if we have destroyed needed number of the spheres to finish the wave
+	// and start new wave if the number is reached
+	if ((DestroyedSpheres / DestroyedSpheresPerWave) > (PreviousDestroyedSpheres / DestroyedSpheresPerWave))
+	{
+		RecordTelemetry(ESphereHordeTelemetryEvent::WaveEnd, FVector::ZeroVector, CurrentWaveNumber, DestroyedSpheres);
+		CurrentWaveNumber++;
+		RecordTelemetry(ESphereHordeTelemetryEvent::WaveStart, FVector::ZeroVector, CurrentWaveNumber, DestroyedSpheres);
+		if (CreatedSpheresSpawner)
+		{
+			CreatedSpheresSpawner->StartNewWave();
+		}
+	}
+	// start preparing the next wave in the background when the threshold is close,
+	// so the kill that finishes the wave only reveals it
+	else if (GetKillsUntilNextWave() <= PrepareNextWaveKillsAhead && CreatedSpheresSpawner)
+	{
+		CreatedSpheresSpawner->PrepareNextWave();
+	}
+
+	NotifyScoreChanged();
+}
+
+// broadcasts the score change and sends the score and the wave number to the clients through the replicated horde
+void	ASphereHordeGameMode::NotifyScoreChanged()
+{
+	OnScoreChanged.Broadcast(DestroyedSpheres, CurrentWaveNumber);
+
+	ASphereHordeReplicatedHorde* ReplicatedHorde = CreatedSpheresSpawner ? CreatedSpheresSpawner->GetReplicatedHorde() : nullptr;
+	if (ReplicatedHorde)
+	{
+		ReplicatedHorde->SetScore(DestroyedSpheres, CurrentWaveNumber);
+	}
 }
 
 // return current wave number
@@ -82,21 +278,306 @@ int32 ASphereHordeGameMode::GetCurrentDestroyedSpheresNumber() const
 	return DestroyedSpheres;
 }
 
-// checks if the sphere is in range of some distance from the spawner (1500.f) by default;
-bool ASphereHordeGameMode::isInRangeFromTheOrigin(ASphereTarget* TargetSphere) const
+// return number of the in range kills left to start the next wave
+int32 ASphereHordeGameMode::GetKillsUntilNextWave() const
+{
+	return DestroyedSpheresPerWave - (DestroyedSpheres % DestroyedSpheresPerWave);
+}
+
+// return number of the targets that are placed and not destroyed yet
+int32 ASphereHordeGameMode::GetLiveTargetsNumber() const
+{
+	return LiveTargets;
+}
+
+// return the spawned spheres spawner
+ARadialActorsSpawner* ASphereHordeGameMode::GetSpheresSpawner() const
+{
+	return CreatedSpheresSpawner;
+}
+
+// registers a target placed by the spawner, in range targets are added to the counter of their wave
+void ASphereHordeGameMode::RegisterSpawnedTarget(const ASphereTarget* TargetSphere)
+{
+	if (TargetSphere)
+	{
+		RegisterSpawnedTarget(TargetSphere->GetWaveId(), TargetSphere->GetShell());
+	}
+}
+
+// registers a target by its tags, in range targets are added to the counter of their wave
+void ASphereHordeGameMode::RegisterSpawnedTarget(int32 WaveId, ESphereTargetShell Shell)
+{
+	LiveTargets++;
+
+	if (Shell == ESphereTargetShell::Inner)
+	{
+		RemainingInRangeTargetsPerWave.FindOrAdd(WaveId)++;
+	}
+}
+
+// removes a target that was registered and dropped without being destroyed, it is not counted as a kill
+void ASphereHordeGameMode::UnregisterSpawnedTarget(int32 WaveId, ESphereTargetShell Shell)
+{
+	LiveTargets = FMath::Max(LiveTargets - 1, 0);
+
+	if (Shell == ESphereTargetShell::Inner)
+	{
+		if (int32* RemainingTargets = RemainingInRangeTargetsPerWave.Find(WaveId))
+		{
+			*RemainingTargets = FMath::Max(*RemainingTargets - 1, 0);
+		}
+	}
+}
+
+// return number of the in range targets of the wave that are still alive
+int32 ASphereHordeGameMode::GetRemainingInRangeTargets(int32 WaveId) const
+{
+	const int32* RemainingTargets = RemainingInRangeTargetsPerWave.Find(WaveId);
+	return RemainingTargets ? *RemainingTargets : 0;
+}
+
+// return number of the in range targets of the current wave that are still alive
+int32 ASphereHordeGameMode::GetRemainingInRangeTargetsInCurrentWave() const
+{
+	return GetRemainingInRangeTargets(CurrentWaveNumber);
+}
+
+// get the path of the snapshot file by its name
+FString ASphereHordeGameMode::GetHordeSnapshotPath(const FString& SnapshotName) const
+{
+	return FPaths::ProjectSavedDir() / TEXT("HordeSnapshots") / (SnapshotName + TEXT(".hordesnap"));
+}
+
+// writes the binary snapshot of the horde, the wave, the score, the spawner rules and the live targets
+void ASphereHordeGameMode::SaveHordeSnapshot(const FString& SnapshotName)
 {
-	// get the position of twoo objects
-	FVector TargetSpherePosition = TargetSphere->GetActorLocation();
-	FVector SpawnerPosition = CreatedSpheresSpawner->GetActorLocation();
+	if (!CreatedSpheresSpawner)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("There is no spawner to save the horde from"))
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	FSphereHordeSnapshot Snapshot;
+	Snapshot.CurrentWaveNumber = CurrentWaveNumber;
+	Snapshot.DestroyedSpheres = DestroyedSpheres;
+	CreatedSpheresSpawner->WriteSnapshot(Snapshot);
+
+	const FString SnapshotPath = GetHordeSnapshotPath(SnapshotName);
+	if (!Snapshot.SaveToFile(SnapshotPath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FAILED to write the horde snapshot %s"), *SnapshotPath)
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Saved the horde snapshot %s, %d targets in %.2f ms"), *SnapshotPath, Snapshot.Targets.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0)
+}
 
-	// calculate the distance, if the distance is smaller than predefined radius - we returrn true and say
-	// that sphere is in range
-	float distance = (TargetSpherePosition - SpawnerPosition).Size();
-	// we take a half of disntace - as a radius
-	if (distance <= (SpheresDistanceFromOrigin))
+// replaces the horde with the one from the snapshot, the targets are placed through the spawner batched path
+void ASphereHordeGameMode::LoadHordeSnapshot(const FString& SnapshotName)
+{
+	if (!CreatedSpheresSpawner)
 	{
-		return true;
+		UE_LOG(LogTemp, Warning, TEXT("There is no spawner to restore the horde to"))
+		return;
 	}
 
-	return false;
+	const double StartTime = FPlatformTime::Seconds();
+
+	FSphereHordeSnapshot Snapshot;
+	const FString SnapshotPath = GetHordeSnapshotPath(SnapshotName);
+	if (!Snapshot.LoadFromFile(SnapshotPath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FAILED to read the horde snapshot %s"), *SnapshotPath)
+		return;
+	}
+
+	// the counters are rebuilt from the restored targets as the spawner registers them
+	CurrentWaveNumber = Snapshot.CurrentWaveNumber;
+	DestroyedSpheres = Snapshot.DestroyedSpheres;
+	RemainingInRangeTargetsPerWave.Reset();
+	LiveTargets = 0;
+	CreatedSpheresSpawner->RestoreSnapshot(Snapshot);
+	NotifyScoreChanged();
+
+	UE_LOG(LogTemp, Log, TEXT("Loaded the horde snapshot %s, %d targets in %.2f ms"), *SnapshotPath, Snapshot.Targets.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0)
+}
+
+// starts the next wave at once with the number of the actors, the wave is counted as if the previous one was finished
+void ASphereHordeGameMode::ForceHordeWave(int32 ActorsNb)
+{
+	if (!CreatedSpheresSpawner || ActorsNb <= 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ForceHordeWave needs the spawner and a positive number of the actors"))
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	RecordTelemetry(ESphereHordeTelemetryEvent::WaveEnd, FVector::ZeroVector, CurrentWaveNumber, DestroyedSpheres);
+	CurrentWaveNumber++;
+	RecordTelemetry(ESphereHordeTelemetryEvent::WaveStart, FVector::ZeroVector, CurrentWaveNumber, DestroyedSpheres);
+
+	CreatedSpheresSpawner->ForceNextWaveSize(ActorsNb);
+	CreatedSpheresSpawner->StartNewWave();
+	NotifyScoreChanged();
+
+	UE_LOG(LogTemp, Log, TEXT("Forced the wave %d with %d actors in %.2f ms, %d live targets"), CurrentWaveNumber, ActorsNb, (FPlatformTime::Seconds() - StartTime) * 1000.0, LiveTargets)
+}
+
+// the recorded input is written when the game ends
+void ASphereHordeGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// the writer thread writes the events left in the ring buffer before it stops
+	Telemetry.Reset();
+
+	if (InputLogMode == ESphereHordeInputLogMode::Record)
+	{
+		const FString InputLogPath = GetInputLogPath(InputLogName);
+		if (!InputLog.SaveToFile(InputLogPath))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("FAILED to write the input log %s"), *InputLogPath)
+			return;
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Saved the input log %s, %d frames, seed %d"), *InputLogPath, InputLog.Frames.Num(), InputLog.SpawnSeed)
+	}
+}
+
+// get the path of the input log file by its name
+FString ASphereHordeGameMode::GetInputLogPath(const FString& LogName) const
+{
+	return FPaths::ProjectSavedDir() / TEXT("HordeReplays") / (LogName + TEXT(".hordeinput"));
+}
+
+// reads the input log settings from the command line, -HordeRecord=<name> records the input to Saved/HordeReplays/<name>.hordeinput,
+// -HordeReplay=<name> replays it, -HordeSeed=<seed> sets the spawn seed of a recorded or a normal game
+int32 ASphereHordeGameMode::SetupInputLog()
+{
+	int32 SpawnSeed = FMath::Rand();
+	FParse::Value(FCommandLine::Get(), TEXT("HordeSeed="), SpawnSeed);
+
+	if (FParse::Value(FCommandLine::Get(), TEXT("HordeReplay="), InputLogName))
+	{
+		const FString InputLogPath = GetInputLogPath(InputLogName);
+		if (!InputLog.LoadFromFile(InputLogPath))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("FAILED to read the input log %s"), *InputLogPath)
+			return SpawnSeed;
+		}
+
+		InputLogMode = ESphereHordeInputLogMode::Replay;
+		UE_LOG(LogTemp, Log, TEXT("Replaying the input log %s, %d frames, seed %d"), *InputLogPath, InputLog.Frames.Num(), InputLog.SpawnSeed)
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("HordeRecord="), InputLogName))
+	{
+		float FixedFrameRate = 60.f;
+		FParse::Value(FCommandLine::Get(), TEXT("HordeFixedFps="), FixedFrameRate);
+
+		InputLog.SpawnSeed = SpawnSeed;
+		InputLog.FixedDeltaTime = 1.f / FMath::Max(FixedFrameRate, 1.f);
+		InputLog.Frames.Reset();
+		InputLogMode = ESphereHordeInputLogMode::Record;
+	}
+	else
+	{
+		return SpawnSeed;
+	}
+
+	// the recorded and the replayed games run at the same fixed timestep, so the movement and the waves match frame to frame
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(InputLog.FixedDeltaTime);
+
+	return InputLog.SpawnSeed;
+}
+
+// get the mode of the input log
+ESphereHordeInputLogMode ASphereHordeGameMode::GetInputLogMode() const
+{
+	return InputLogMode;
+}
+
+// get the input frame of the current game frame to record into, a new frame is added on the first call in a game frame
+FSphereHordeInputFrame* ASphereHordeGameMode::GetRecordedInputFrame()
+{
+	if (InputLogMode != ESphereHordeInputLogMode::Record)
+	{
+		return nullptr;
+	}
+
+	if (InputFrameCounter != GFrameCounter || InputFrameIndex == INDEX_NONE)
+	{
+		InputFrameCounter = GFrameCounter;
+		InputFrameIndex = InputLog.Frames.AddDefaulted();
+	}
+
+	return &InputLog.Frames[InputFrameIndex];
+}
+
+// get the input frame of the current game frame to replay, nullptr once the replay is over
+const FSphereHordeInputFrame* ASphereHordeGameMode::GetReplayedInputFrame(bool& bIsNewFrame)
+{
+	bIsNewFrame = false;
+	if (InputLogMode != ESphereHordeInputLogMode::Replay)
+	{
+		return nullptr;
+	}
+
+	if (InputFrameCounter != GFrameCounter || InputFrameIndex == INDEX_NONE)
+	{
+		InputFrameCounter = GFrameCounter;
+		InputFrameIndex++;
+		bIsNewFrame = true;
+	}
+
+	// the live input takes over once all the recorded frames are played
+	if (!InputLog.Frames.IsValidIndex(InputFrameIndex))
+	{
+		UE_LOG(LogTemp, Log, TEXT("The input replay is over after %d frames, wave %d, destroyed spheres %d"), InputLog.Frames.Num(), CurrentWaveNumber, DestroyedSpheres)
+		InputLogMode = ESphereHordeInputLogMode::None;
+		FApp::SetUseFixedTimeStep(false);
+		bIsNewFrame = false;
+		return nullptr;
+	}
+
+	return &InputLog.Frames[InputFrameIndex];
+}
+
+// starts the telemetry recorder, the events are appended to Saved/HordeTelemetry/<date>.ndjson or .hordetelemetry
+void ASphereHordeGameMode::StartTelemetry()
+{
+	FString TelemetryFormatName;
+	const bool bIsRequested = FParse::Value(FCommandLine::Get(), TEXT("HordeTelemetry="), TelemetryFormatName) || FParse::Param(FCommandLine::Get(), TEXT("HordeTelemetry"));
+	if (!bRecordTelemetry && !bIsRequested)
+	{
+		return;
+	}
+
+	const ESphereHordeTelemetryFormat TelemetryFormat = TelemetryFormatName.Equals(TEXT("binary"), ESearchCase::IgnoreCase) ? ESphereHordeTelemetryFormat::Binary : ESphereHordeTelemetryFormat::Json;
+	const FString TelemetryPath = FPaths::ProjectSavedDir() / TEXT("HordeTelemetry") /
+		(FDateTime::Now().ToString() + ((TelemetryFormat == ESphereHordeTelemetryFormat::Binary) ? TEXT(".hordetelemetry") : TEXT(".ndjson")));
+
+	Telemetry = MakeUnique<FSphereHordeTelemetry>(TelemetryPath, TelemetryFormat);
+	UE_LOG(LogTemp, Log, TEXT("Recording the horde telemetry to %s"), *TelemetryPath)
+
+	RecordTelemetry(ESphereHordeTelemetryEvent::WaveStart, FVector::ZeroVector, CurrentWaveNumber, DestroyedSpheres);
+}
+
+// pushes the telemetry event to the writer thread, the game time is the time of the event
+void ASphereHordeGameMode::RecordTelemetry(ESphereHordeTelemetryEvent Type, const FVector& Location, int32 WaveId, float Value)
+{
+	if (Telemetry)
+	{
+		Telemetry->Record(Type, GetWorld()->GetTimeSeconds(), Location, WaveId, Value);
+	}
+}
+
+// checks if the next destruction vfx is to be played
+bool ASphereHordeGameMode::ShouldPlayDestructionVfx() const
+{
+	return CreatedSpheresSpawner ? CreatedSpheresSpawner->ShouldPlayDestructionVfx() : true;
 }
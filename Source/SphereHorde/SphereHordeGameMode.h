@@ -4,10 +4,19 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "Engine/StreamableManager.h"
+#include "SphereHordeInputLog.h"
+#include "SphereHordeTelemetry.h"
 #include "SphereHordeGameMode.generated.h"
 
 class ARadialActorsSpawner;
+class ASphereHordeBotController;
 class ASphereTarget;
+enum class ESphereTargetShell : uint8;
+struct FSphereTargetKill;
+
+// broadcast when the number of the destroyed spheres or the wave number changes
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnHordeScoreChanged, int32 /* DestroyedSpheres */, int32 /* CurrentWaveNumber */);
 
 UCLASS(minimalapi)
 class ASphereHordeGameMode : public AGameModeBase
@@ -19,10 +28,21 @@ public:
 
 	void BeginPlay() override;
 
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// radial actor spawner
 	UPROPERTY(EditDefaultsOnly)
 	TSubclassOf<ARadialActorsSpawner> SpheresSpawner;
 
+	// the soak test bot, it possesses the first player pawn when the game is started with -SoakBot
+	UPROPERTY(EditDefaultsOnly, Category = "Soak")
+	TSubclassOf<ASphereHordeBotController> SoakBotClass;
+
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+
+	// get the pawn the horde is spawned around, the first player pawn or the pawn of the soak bot
+	APawn*	GetHordePawn() const;
+
 	// the number of the spheres needed to be destoyed in order to start new wave
 	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "10", ClampMax = "15", UIMin = "10", UIMax = "30"), Category = "Gameplay")
 	int32	DestroyedSpheresPerWave = 10;
@@ -34,15 +54,89 @@ public:
 	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "1500.0", ClampMax = "2000.0", UIMin = "1500.0", UIMax = "2000.0"), Category = "Gameplay")
 	float	SpheresDistanceFromOrigin;
 
+	// the number of the kills left before the next wave, when the spawner starts preparing the next wave in the background
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0", ClampMax = "15", UIMin = "0", UIMax = "15"), Category = "Gameplay")
+	int32	PrepareNextWaveKillsAhead = 3;
+
 	// updates the number of destroyed spheres
 	void	UpdatedNubmerOfDestroyedSpheres(ASphereTarget* TargetSphere);
 
+	// updates the number of destroyed spheres by the tags of a target that is not an actor, such as a moving horde instance
+	void	UpdatedNubmerOfDestroyedSpheres(int32 WaveId, ESphereTargetShell Shell, const FVector& Location);
+
+	// updates the number of destroyed spheres for a batch of the targets, such as the targets caught by a blast,
+	// the targets are returned to the spawner, the wave is checked and the score is sent once for the whole batch with OtherKills
+	void	UpdatedNubmerOfDestroyedSpheres(TArrayView<ASphereTarget* const> TargetSpheres, TArrayView<const FSphereTargetKill> OtherKills);
+
+	// updates the number of destroyed spheres for a batch of the targets that are not actors
+	void	UpdatedNubmerOfDestroyedSpheres(TArrayView<const FSphereTargetKill> Kills);
+
+	// records the events of the horde to Saved/HordeTelemetry, it can also be turned on with -HordeTelemetry or -HordeTelemetry=binary
+	UPROPERTY(EditDefaultsOnly, Category = "Telemetry")
+	bool	bRecordTelemetry = false;
+
+	// checks if the next destruction vfx is to be played, the spawner lowers the vfx density when over the frame budget
+	bool	ShouldPlayDestructionVfx() const;
+
+	// pushes the telemetry event to the writer thread, does nothing if the telemetry is not recorded
+	void	RecordTelemetry(ESphereHordeTelemetryEvent Type, const FVector& Location, int32 WaveId, float Value = 0.f);
+
 	// get the number of the current wave
 	int32	GetCurrentWaveNumber() const;
 
 	// get the number of the spheres destroyed
 	int32	GetCurrentDestroyedSpheresNumber() const;
 
+	// get the number of the in range kills left to start the next wave
+	int32	GetKillsUntilNextWave() const;
+
+	// get the number of the targets that are placed and not destroyed yet, in all the waves
+	int32	GetLiveTargetsNumber() const;
+
+	// get the spawned spheres spawner
+	ARadialActorsSpawner*	GetSpheresSpawner() const;
+
+	// the event of the score or wave number change, the HUD redraws its text only on it
+	FOnHordeScoreChanged	OnScoreChanged;
+
+	// registers a target placed by the spawner, in range targets are added to the counter of their wave
+	void	RegisterSpawnedTarget(const ASphereTarget* TargetSphere);
+
+	// registers a target by its tags, in range targets are added to the counter of their wave
+	void	RegisterSpawnedTarget(int32 WaveId, ESphereTargetShell Shell);
+
+	// removes a target that was registered and dropped without being destroyed, it is not counted as a kill
+	void	UnregisterSpawnedTarget(int32 WaveId, ESphereTargetShell Shell);
+
+	// get the number of the in range targets of the wave that are still alive
+	int32	GetRemainingInRangeTargets(int32 WaveId) const;
+
+	// get the number of the in range targets of the current wave that are still alive
+	int32	GetRemainingInRangeTargetsInCurrentWave() const;
+
+	// writes the binary snapshot of the horde to Saved/HordeSnapshots/<SnapshotName>.hordesnap
+	UFUNCTION(Exec)
+	void	SaveHordeSnapshot(const FString& SnapshotName);
+
+	// replaces the horde with the one from Saved/HordeSnapshots/<SnapshotName>.hordesnap
+	UFUNCTION(Exec)
+	void	LoadHordeSnapshot(const FString& SnapshotName);
+
+	// starts the next wave at once with the number of the actors, for the stress tests,
+	// the spawner is tuned at runtime with the horde.* console variables
+	UFUNCTION(Exec)
+	void	ForceHordeWave(int32 ActorsNb);
+
+	// get the mode of the input log, the character records or replays its input through the game mode
+	ESphereHordeInputLogMode	GetInputLogMode() const;
+
+	// get the input frame of the current game frame to record into, a new frame is added on the first call in a game frame
+	FSphereHordeInputFrame*	GetRecordedInputFrame();
+
+	// get the input frame of the current game frame to replay, nullptr once the replay is over,
+	// bIsNewFrame is true on the first call in a game frame, when the recorded actions are to be played
+	const FSphereHordeInputFrame*	GetReplayedInputFrame(bool& bIsNewFrame);
+
 private:
 	// a spheres spawners 
 	ARadialActorsSpawner* CreatedSpheresSpawner;
@@ -53,8 +147,55 @@ private:
 	// the number of the current wave
 	int32	CurrentWaveNumber;
 
-	// checks if the sphere is in range of some distance from the spawner (1500.f) by default;
-	bool	isInRangeFromTheOrigin(ASphereTarget* TargetSphere) const;
+	// the number of the in range targets that are still alive, per wave id
+	TMap<int32, int32>	RemainingInRangeTargetsPerWave;
+
+	// the number of the targets that are placed and not destroyed yet
+	int32	LiveTargets;
+
+	// the spawned soak test bot
+	UPROPERTY()
+	ASphereHordeBotController*	SoakBot;
+
+	// the recorded or replayed input
+	FSphereHordeInputLog	InputLog;
+	ESphereHordeInputLogMode	InputLogMode;
+	FString	InputLogName;
+
+	// the index of the frame in the input log and the game frame it was taken at
+	int32	InputFrameIndex;
+	uint64	InputFrameCounter;
+
+	// reads the input log settings from the command line, loads the replayed log
+	// and switches the engine to the fixed timestep, returns the spawn seed
+	int32	SetupInputLog();
+
+	// get the path of the input log file by its name
+	FString	GetInputLogPath(const FString& LogName) const;
+
+	// the telemetry recorder, it owns the writer thread
+	TUniquePtr<FSphereHordeTelemetry>	Telemetry;
+
+	// starts the telemetry recorder if it is requested
+	void	StartTelemetry();
+
+	// the handle that keeps the preloaded pawn assets in memory
+	TSharedPtr<FStreamableHandle>	PawnAssetsHandle;
+
+	// requests the asynchronous load of the softly referenced assets of the default pawn
+	void	PreloadPawnAssets();
+
+	// get the path of the snapshot file by its name
+	FString	GetHordeSnapshotPath(const FString& SnapshotName) const;
+
+	// broadcasts the score change and sends the score and the wave number to the clients through the replicated horde
+	void	NotifyScoreChanged();
+
+	// counts the destroyed target, returns true if it is counted for the next wave
+	bool	CountDestroyedSphere(int32 WaveId, ESphereTargetShell Shell, const FVector& Location);
+
+	// checks the wave once for the kills counted since PreviousDestroyedSpheres and sends the score
+	void	FinishDestroyedSpheresUpdate(int32 PreviousDestroyedSpheres);
 };
 
 
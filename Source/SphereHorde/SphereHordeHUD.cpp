@@ -2,12 +2,29 @@
 
 #include "SphereHordeHUD.h"
 #include "Engine/Canvas.h"
+#include "Engine/Engine.h"
+#include "Engine/Font.h"
 #include "Engine/Texture2D.h"
 #include "TextureResource.h"
 #include "CanvasItem.h"
+#include "EngineUtils.h"
+#include "Misc/App.h"
 #include "SphereHordeGameMode.h"
+#include "SphereHordeReplicatedHorde.h"
+#include "RadialActorsSpawner.h"
 #include "UObject/ConstructorHelpers.h"
 
+// the names of the arguments of the score and the perf panel formats, the arguments are looked up by them on each rebuild
+static const FString	ScoreMessageArgument(TEXT("ScoreMessage"));
+static const FString	DestroyedSpheresArgument(TEXT("DestroyedSpheres"));
+static const FString	WaveMessageArgument(TEXT("WaveMessage"));
+static const FString	WaveNumberArgument(TEXT("WaveNumber"));
+static const FString	FrameMsArgument(TEXT("FrameMs"));
+static const FString	FrameTenthsArgument(TEXT("FrameTenths"));
+static const FString	LiveTargetsArgument(TEXT("LiveTargets"));
+static const FString	WaveSpawnMsArgument(TEXT("WaveSpawnMs"));
+static const FString	WaveSpawnTenthsArgument(TEXT("WaveSpawnTenths"));
+
 ASphereHordeHUD::ASphereHordeHUD()
 {
 	// Set the crosshair texture
@@ -15,6 +32,118 @@ ASphereHordeHUD::ASphereHordeHUD()
 	CrosshairTex = CrosshairTexObj.Object;
 	ScoreMessage = "Score";
 	WaveMessage = "Wave";
+
+	bIsBoundToScore = false;
+	PerfAccumulatedSeconds = 0.f;
+	PerfAccumulatedFrames = 0;
+	ShownFrameTenthsMs = INDEX_NONE;
+	ShownLiveTargets = INDEX_NONE;
+	ShownWaveSpawnTenthsMs = INDEX_NONE;
+}
+
+void ASphereHordeHUD::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// the formats are compiled once, the numbers are set as the integer arguments, so a rebuild does not print any string
+	ScoreFormat = FTextFormat::FromString(TEXT("{ScoreMessage} : {DestroyedSpheres} {WaveMessage} : {WaveNumber}"));
+	ScoreArguments.Add(ScoreMessageArgument, FText::FromString(ScoreMessage));
+	ScoreArguments.Add(DestroyedSpheresArgument, 0);
+	ScoreArguments.Add(WaveMessageArgument, FText::FromString(WaveMessage));
+	ScoreArguments.Add(WaveNumberArgument, 0);
+
+	PerfFormat = FTextFormat::FromString(TEXT("Frame : {FrameMs}.{FrameTenths} ms  Targets : {LiveTargets}  Wave spawn : {WaveSpawnMs}.{WaveSpawnTenths} ms"));
+	PerfArguments.Add(FrameMsArgument, 0);
+	PerfArguments.Add(FrameTenthsArgument, 0);
+	PerfArguments.Add(LiveTargetsArgument, 0);
+	PerfArguments.Add(WaveSpawnMsArgument, 0);
+	PerfArguments.Add(WaveSpawnTenthsArgument, 0);
+
+	BindScoreEvents();
+}
+
+void ASphereHordeHUD::BindScoreEvents()
+{
+	// the game mode exists on the server only
+	ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(GetWorld()->GetAuthGameMode());
+	if (GameMode)
+	{
+		GameMode->OnScoreChanged.AddUObject(this, &ASphereHordeHUD::OnScoreChanged);
+		OnScoreChanged(GameMode->GetCurrentDestroyedSpheresNumber(), GameMode->GetCurrentWaveNumber());
+		bIsBoundToScore = true;
+		return;
+	}
+
+	// the clients get the score from the replicated horde, it may not be replicated yet
+	for (TActorIterator<ASphereHordeReplicatedHorde> It(GetWorld()); It; ++It)
+	{
+		It->OnScoreChanged.AddUObject(this, &ASphereHordeHUD::OnScoreChanged);
+		OnScoreChanged(It->GetDestroyedSpheres(), It->GetCurrentWaveNumber());
+		bIsBoundToScore = true;
+		return;
+	}
+}
+
+void ASphereHordeHUD::OnScoreChanged(int32 DestroyedSpheres, int32 CurrentWaveNumber)
+{
+	ScoreArguments.FindChecked(DestroyedSpheresArgument) = DestroyedSpheres;
+	ScoreArguments.FindChecked(WaveNumberArgument) = CurrentWaveNumber;
+	ScoreText = FText::Format(ScoreFormat, ScoreArguments);
+}
+
+void ASphereHordeHUD::ToggleHordePerfPanel()
+{
+	bShowPerfPanel = !bShowPerfPanel;
+}
+
+void ASphereHordeHUD::UpdatePerfPanel()
+{
+	PerfAccumulatedSeconds += FApp::GetDeltaTime();
+	PerfAccumulatedFrames++;
+	if (PerfAccumulatedSeconds < PerfPanelRefreshInterval)
+	{
+		return;
+	}
+
+	const int32 FrameTenthsMs = FMath::RoundToInt(PerfAccumulatedSeconds * 10000.f / PerfAccumulatedFrames);
+	PerfAccumulatedSeconds = 0.f;
+	PerfAccumulatedFrames = 0;
+
+	// the live targets and the spawn time are known on the server only
+	int32 LiveTargets = 0;
+	int32 WaveSpawnTenthsMs = 0;
+	ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(GetWorld()->GetAuthGameMode());
+	if (GameMode)
+	{
+		LiveTargets = GameMode->GetLiveTargetsNumber();
+		if (const ARadialActorsSpawner* Spawner = GameMode->GetSpheresSpawner())
+		{
+			WaveSpawnTenthsMs = FMath::RoundToInt(Spawner->GetLastWaveSpawnMs() * 10.f);
+		}
+	}
+
+	// the text is rebuilt only if something shown has changed
+	if (FrameTenthsMs == ShownFrameTenthsMs && LiveTargets == ShownLiveTargets && WaveSpawnTenthsMs == ShownWaveSpawnTenthsMs)
+	{
+		return;
+	}
+	ShownFrameTenthsMs = FrameTenthsMs;
+	ShownLiveTargets = LiveTargets;
+	ShownWaveSpawnTenthsMs = WaveSpawnTenthsMs;
+
+	PerfArguments.FindChecked(FrameMsArgument) = FrameTenthsMs / 10;
+	PerfArguments.FindChecked(FrameTenthsArgument) = FrameTenthsMs % 10;
+	PerfArguments.FindChecked(LiveTargetsArgument) = LiveTargets;
+	PerfArguments.FindChecked(WaveSpawnMsArgument) = WaveSpawnTenthsMs / 10;
+	PerfArguments.FindChecked(WaveSpawnTenthsArgument) = WaveSpawnTenthsMs % 10;
+	PerfText = FText::Format(PerfFormat, PerfArguments);
+}
+
+void ASphereHordeHUD::DrawCachedText(const FText& Text, float X, float Y, const FLinearColor& Color)
+{
+	FCanvasTextItem TextItem(FVector2D(X, Y), Text, Font ? Font : GEngine->GetMediumFont(), Color);
+	TextItem.Scale = FVector2D(1.5f);
+	Canvas->DrawItem(TextItem);
 }
 
 void ASphereHordeHUD::DrawHUD()
@@ -35,11 +164,21 @@ void ASphereHordeHUD::DrawHUD()
 	TileItem.BlendMode = SE_BLEND_Translucent;
 	Canvas->DrawItem( TileItem );
 
-	// draw the score and wave number to the HUD
-	ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(GetWorld()->GetAuthGameMode());
-	if (GameMode)
+	// the clients wait for the replicated horde to show up
+	if (!bIsBoundToScore)
+	{
+		BindScoreEvents();
+	}
+
+	// draw the cached score and wave number to the HUD, the text is rebuilt only on the score events
+	if (bIsBoundToScore)
+	{
+		DrawCachedText(ScoreText, 0.f, 0.f, FLinearColor::Black);
+	}
+
+	if (bShowPerfPanel)
 	{
-		FString  FinalScoreText = FString::Printf(TEXT("%s : %d %s : %d"), *ScoreMessage, GameMode->GetCurrentDestroyedSpheresNumber(), *WaveMessage, GameMode->GetCurrentWaveNumber());
-		DrawText(FinalScoreText, FLinearColor::Black, 0, 0, Font, 1.5f, false);
+		UpdatePerfPanel();
+		DrawCachedText(PerfText, 0.f, 30.f, FLinearColor::Black);
 	}
 }
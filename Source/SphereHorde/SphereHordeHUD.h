@@ -19,7 +19,12 @@ public:
 	/** Primary draw call for the HUD */
 	virtual void DrawHUD() override;
 
+	/** Shows or hides the perf panel */
+	UFUNCTION(Exec)
+	void ToggleHordePerfPanel();
+
 protected:
+	virtual void BeginPlay() override;
 	
 	UPROPERTY(EditDefaultsOnly, Category = "Score")
 	FString		ScoreMessage;
@@ -30,8 +35,52 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Score")
 	UFont*		Font;
 
+	/** Whether the perf panel with the frame time, live targets and wave spawn time is drawn */
+	UPROPERTY(EditDefaultsOnly, Category = "Perf")
+	bool		bShowPerfPanel = false;
+
+	/** How often the perf panel text is rebuilt, in seconds, the frame time is averaged over this interval */
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.05"), Category = "Perf")
+	float		PerfPanelRefreshInterval = 0.25f;
+
 private:
 	/** Crosshair asset pointer */
 	class UTexture2D* CrosshairTex;
+
+	/** The score text, rebuilt only when the score or the wave changes */
+	FText		ScoreText;
+
+	/** The perf panel text, rebuilt only when the shown values change */
+	FText		PerfText;
+
+	/** The compiled formats of the score and the perf panel texts and their arguments, the arguments are updated in place on each rebuild */
+	FTextFormat				ScoreFormat;
+	FTextFormat				PerfFormat;
+	FFormatNamedArguments	ScoreArguments;
+	FFormatNamedArguments	PerfArguments;
+
+	/** True once the HUD listens to the score events of the game mode or of the replicated horde */
+	bool		bIsBoundToScore;
+
+	/** The frame time accumulated since the perf panel was refreshed */
+	float		PerfAccumulatedSeconds;
+	int32		PerfAccumulatedFrames;
+
+	/** The values shown in the perf panel, frame time in tenths of milliseconds */
+	int32		ShownFrameTenthsMs;
+	int32		ShownLiveTargets;
+	int32		ShownWaveSpawnTenthsMs;
+
+	/** Subscribes to the score events, the game mode on the server, the replicated horde on the clients */
+	void		BindScoreEvents();
+
+	/** Rebuilds the score text */
+	void		OnScoreChanged(int32 DestroyedSpheres, int32 CurrentWaveNumber);
+
+	/** Accumulates the frame time and rebuilds the perf panel text if the shown values changed */
+	void		UpdatePerfPanel();
+
+	/** Draws the cached text at the position */
+	void		DrawCachedText(const FText& Text, float X, float Y, const FLinearColor& Color);
 };
 
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeInputLog.h"
+#include "SphereHordeBinaryFile.h"
+
+// the log file starts with the magic number 'SHIL' and the version
+static const FSphereHordeBinaryFormat	SphereHordeInputLogFormat = { 0x4C494853, 1 };
+
+FArchive& operator<<(FArchive& Ar, FSphereHordeInputLog& InputLog)
+{
+	Ar << InputLog.SpawnSeed;
+	Ar << InputLog.FixedDeltaTime;
+
+	// the frames are written as a flat memory block
+	SerializeHordeRawArray(Ar, InputLog.Frames);
+	return Ar;
+}
+
+// writes the log to the file in one block
+bool	FSphereHordeInputLog::SaveToFile(const FString& FilePath)
+{
+	return SaveHordeBinaryFile(FilePath, SphereHordeInputLogFormat, *this, 64 + Frames.Num() * sizeof(FSphereHordeInputFrame));
+}
+
+// reads the log from the file, returns false if the file is missing or is not a valid log
+bool	FSphereHordeInputLog::LoadFromFile(const FString& FilePath)
+{
+	return LoadHordeBinaryFile(FilePath, SphereHordeInputLogFormat, *this);
+}
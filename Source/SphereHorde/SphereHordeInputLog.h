@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+	define the binary log of the player input, it is recorded and replayed at a fixed timestep
+
+	1. the spawn seed, so the replayed waves are placed at the same positions
+	2. the fixed timestep the log was recorded at
+	3. flat array of the input frames, one per game frame, the axes and the pressed actions
+*/
+
+// the mode of the input log, set from the command line, -HordeRecord=<name> or -HordeReplay=<name>
+enum class ESphereHordeInputLogMode : uint8
+{
+	None,
+	Record,
+	Replay,
+};
+
+// the actions captured in a frame
+enum class ESphereHordeInputAction : uint8
+{
+	None			= 0,
+	Fire			= 1 << 0,
+	JumpPressed		= 1 << 1,
+	JumpReleased	= 1 << 2,
+};
+ENUM_CLASS_FLAGS(ESphereHordeInputAction);
+
+// the input of one frame, the array of the frames is serialized as a raw memory block
+struct FSphereHordeInputFrame
+{
+	// the axes bound in SetupPlayerInputComponent
+	float	MoveForward;
+	float	MoveRight;
+	float	Turn;
+	float	TurnRate;
+	float	LookUp;
+	float	LookUpRate;
+
+	// the actions pressed in the frame
+	ESphereHordeInputAction	Actions;
+
+	uint8	Padding[3];
+
+	FSphereHordeInputFrame()
+		: MoveForward(0.f)
+		, MoveRight(0.f)
+		, Turn(0.f)
+		, TurnRate(0.f)
+		, LookUp(0.f)
+		, LookUpRate(0.f)
+		, Actions(ESphereHordeInputAction::None)
+		, Padding{ 0, 0, 0 }
+	{
+	}
+};
+
+// the recorded input of a whole session
+struct FSphereHordeInputLog
+{
+	// the seed of the spawner random stream
+	int32	SpawnSeed = 0;
+
+	// the fixed timestep the log was recorded at, in seconds
+	float	FixedDeltaTime = 1.f / 60.f;
+
+	// the recorded frames
+	TArray<FSphereHordeInputFrame>	Frames;
+
+	friend FArchive& operator<<(FArchive& Ar, FSphereHordeInputLog& InputLog);
+
+	// writes the log to the file in one block
+	bool	SaveToFile(const FString& FilePath);
+
+	// reads the log from the file, returns false if the file is missing or is not a valid log
+	bool	LoadFromFile(const FString& FilePath);
+};
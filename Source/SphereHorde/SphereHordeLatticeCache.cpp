@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeLatticeCache.h"
+#include "SphereHordeBinaryFile.h"
+
+// the cache file starts with the magic number 'SHLC' and the version
+static const FSphereHordeBinaryFormat	SphereHordeLatticeFormat = { 0x434C4853, 2 };
+
+// the shells are built from the fixed seed, so the cache file does not depend on the spawn seed of the game
+static const int32	SphereHordeLatticeSeed = 0x5348;
+
+// the radii closer than it are the same radius
+static const float	SphereHordeLatticeRadiusTolerance = 1.f;
+
+// the shell larger than the radius by more than it is not used, most of its points would be outside the radius
+static const float	SphereHordeLatticeMaxRadiusRatio = 1.25f;
+
+FSphereHordeLatticeCache::FSphereHordeLatticeCache()
+{
+	MinDistance = 0.f;
+	MaxPointsPerShell = 0;
+}
+
+// builds the shells for the radii
+void	FSphereHordeLatticeCache::Build(const TArray<float>& Radii, float InMinDistance, int32 InMaxPointsPerShell)
+{
+	MinDistance = FMath::Max(InMinDistance, 1.f);
+	MaxPointsPerShell = FMath::Clamp(InMaxPointsPerShell, 1, MAX_int32 / 2);
+
+	FRandomStream Stream(SphereHordeLatticeSeed);
+	Shells.Reset(Radii.Num());
+	for (float Radius : Radii)
+	{
+		BuildShell(Radius, Stream, Shells.AddDefaulted_GetRef());
+	}
+	Shells.Sort([](const FSphereHordeLatticeShell& A, const FSphereHordeLatticeShell& B) { return A.Radius < B.Radius; });
+}
+
+// checks if the cache has the shells built for the radii and the parameters
+bool	FSphereHordeLatticeCache::Matches(const TArray<float>& Radii, float InMinDistance, int32 InMaxPointsPerShell) const
+{
+	if (Shells.Num() != Radii.Num() || !FMath::IsNearlyEqual(MinDistance, FMath::Max(InMinDistance, 1.f)) || MaxPointsPerShell != InMaxPointsPerShell)
+	{
+		return false;
+	}
+
+	for (float Radius : Radii)
+	{
+		if (!Shells.ContainsByPredicate([Radius](const FSphereHordeLatticeShell& Shell) { return FMath::IsNearlyEqual(Shell.Radius, Radius, SphereHordeLatticeRadiusTolerance); }))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// get the smallest shell that covers the radius
+const FSphereHordeLatticeShell*	FSphereHordeLatticeCache::FindShell(float Radius) const
+{
+	for (const FSphereHordeLatticeShell& Shell : Shells)
+	{
+		if (Shell.Radius + SphereHordeLatticeRadiusTolerance >= Radius)
+		{
+			return (Shell.Radius <= Radius * SphereHordeLatticeMaxRadiusRatio && Shell.Num() > 0) ? &Shell : nullptr;
+		}
+	}
+	return nullptr;
+}
+
+// get the number of the shells
+int32	FSphereHordeLatticeCache::Num() const
+{
+	return Shells.Num();
+}
+
+// builds the jittered spiral of the radius, the spiral spreads the points evenly over the disc, the jitter breaks its visible pattern,
+// then the points closer than the minimum distance to the kept ones are dropped, through a grid of the cells of the minimum distance
+void	FSphereHordeLatticeCache::BuildShell(float Radius, FRandomStream& Stream, FSphereHordeLatticeShell& OutShell) const
+{
+	OutShell.Radius = Radius;
+	OutShell.Coords.Reset();
+	if (Radius <= 0.f)
+	{
+		return;
+	}
+
+	// the spiral is a bit sparser than the minimum distance, so most of its points are kept after the jitter
+	const float Area = PI * FMath::Square(Radius);
+	const int32 PointsNb = FMath::Clamp(FMath::FloorToInt(Area / FMath::Square(MinDistance * 1.25f)), 1, MaxPointsPerShell);
+	const float PointSpacing = FMath::Sqrt(Area / PointsNb);
+	const float Jitter = FMath::Max(PointSpacing - MinDistance, 0.f) * 0.25f;
+	const float GoldenAngle = PI * (3.f - FMath::Sqrt(5.f));
+
+	const float MinDistanceSquared = FMath::Square(MinDistance);
+	const float MaxPointRadiusSquared = FMath::Square(Radius * 0.999f);
+	const float CoordScale = MAX_int16 / Radius;
+
+	TArray<FVector2D> KeptPoints;
+	KeptPoints.Reserve(PointsNb);
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Cells;
+	Cells.Reserve(PointsNb);
+
+	for (int32 PointId = 0; PointId < PointsNb; PointId++)
+	{
+		const float PointRadius = Radius * FMath::Sqrt((PointId + 0.5f) / PointsNb);
+		float SinAngle, CosAngle;
+		FMath::SinCos(&SinAngle, &CosAngle, PointId * GoldenAngle);
+		const FVector2D Point(
+			PointRadius * CosAngle + Stream.FRandRange(-Jitter, Jitter),
+			PointRadius * SinAngle + Stream.FRandRange(-Jitter, Jitter));
+		if (Point.SizeSquared() >= MaxPointRadiusSquared)
+		{
+			continue;
+		}
+
+		const FIntPoint Cell(FMath::FloorToInt(Point.X / MinDistance), FMath::FloorToInt(Point.Y / MinDistance));
+		bool bIsTooClose = false;
+		for (int32 Y = Cell.Y - 1; Y <= Cell.Y + 1 && !bIsTooClose; Y++)
+		{
+			for (int32 X = Cell.X - 1; X <= Cell.X + 1 && !bIsTooClose; X++)
+			{
+				if (const auto* CellPoints = Cells.Find(FIntPoint(X, Y)))
+				{
+					for (int32 KeptPointId : *CellPoints)
+					{
+						if (FVector2D::DistSquared(KeptPoints[KeptPointId], Point) < MinDistanceSquared)
+						{
+							bIsTooClose = true;
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		if (!bIsTooClose)
+		{
+			Cells.FindOrAdd(Cell).Add(KeptPoints.Add(Point));
+		}
+	}
+
+	OutShell.Coords.Reserve(KeptPoints.Num() * 2);
+	for (const FVector2D& Point : KeptPoints)
+	{
+		OutShell.Coords.Add((int16)FMath::Clamp(FMath::RoundToInt(Point.X * CoordScale), -MAX_int16, (int32)MAX_int16));
+		OutShell.Coords.Add((int16)FMath::Clamp(FMath::RoundToInt(Point.Y * CoordScale), -MAX_int16, (int32)MAX_int16));
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FSphereHordeLatticeCache& Cache)
+{
+	Ar << Cache.MinDistance;
+	Ar << Cache.MaxPointsPerShell;
+
+	// a shell takes at least its radius, the size and the number of its coordinates
+	int32 ShellsNb = Cache.Shells.Num();
+	if (!SerializeHordeArrayNum(Ar, ShellsNb, 12))
+	{
+		return Ar;
+	}
+	if (Ar.IsLoading())
+	{
+		Cache.Shells.SetNum(ShellsNb);
+	}
+
+	// the points of each shell are written as a flat memory block of the quantized coordinates
+	for (FSphereHordeLatticeShell& Shell : Cache.Shells)
+	{
+		Ar << Shell.Radius;
+		if (!SerializeHordeRawArray(Ar, Shell.Coords))
+		{
+			return Ar;
+		}
+
+		// the coordinates come in pairs
+		if (Ar.IsLoading() && (Shell.Coords.Num() % 2) != 0)
+		{
+			Ar.SetError();
+			return Ar;
+		}
+	}
+	return Ar;
+}
+
+// writes the cache to the file in one block
+bool	FSphereHordeLatticeCache::SaveToFile(const FString& FilePath) const
+{
+	return SaveHordeBinaryFile(FilePath, SphereHordeLatticeFormat, *this);
+}
+
+// reads the cache from the file, returns false if the file is missing or is not a valid cache
+bool	FSphereHordeLatticeCache::LoadFromFile(const FString& FilePath)
+{
+	if (!LoadHordeBinaryFile(FilePath, SphereHordeLatticeFormat, *this))
+	{
+		Shells.Reset();
+		return false;
+	}
+	return true;
+}
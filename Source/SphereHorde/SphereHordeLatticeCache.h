@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+	define the cache of the precomputed point sets the waves are placed with, one shell per spawn radius of the waves,
+	each shell is a jittered fibonacci spiral in the disc of its radius with the points kept apart by the minimum distance,
+	the points are quantized to 16 bits relative to the radius of the shell
+
+	the cache is built once and written to a compact binary file, at runtime the points are only rotated,
+	moved to the spawn origin and filtered against the placed targets
+*/
+
+// the points of one shell, in the disc of its radius around the origin
+struct FSphereHordeLatticeShell
+{
+	// the radius of the disc the points are in
+	float	Radius = 0.f;
+
+	// the interleaved X and Y of the points, in units of Radius / MAX_int16
+	TArray<int16>	Coords;
+
+	// get the number of the points
+	int32	Num() const { return Coords.Num() / 2; }
+
+	// get the point relative to the origin of the shell
+	FVector2D	GetPoint(int32 PointId) const
+	{
+		const float CoordScale = Radius / MAX_int16;
+		return FVector2D(Coords[PointId * 2] * CoordScale, Coords[PointId * 2 + 1] * CoordScale);
+	}
+};
+
+class FSphereHordeLatticeCache
+{
+public:
+	FSphereHordeLatticeCache();
+
+	// builds the shells for the radii, the points of each shell are at least MinDistance apart
+	void	Build(const TArray<float>& Radii, float InMinDistance, int32 InMaxPointsPerShell);
+
+	// checks if the cache has the shells built for the radii and the parameters
+	bool	Matches(const TArray<float>& Radii, float InMinDistance, int32 InMaxPointsPerShell) const;
+
+	// get the smallest shell that covers the radius, nullptr if there is none close enough to the radius
+	const FSphereHordeLatticeShell*	FindShell(float Radius) const;
+
+	// get the number of the shells
+	int32	Num() const;
+
+	// writes the cache to the file in one block
+	bool	SaveToFile(const FString& FilePath) const;
+
+	// reads the cache from the file, returns false if the file is missing or is not a valid cache
+	bool	LoadFromFile(const FString& FilePath);
+
+	friend FArchive& operator<<(FArchive& Ar, FSphereHordeLatticeCache& Cache);
+
+private:
+	// the minimum distance between the points and the max number of the points per shell the shells are built with
+	float	MinDistance;
+	int32	MaxPointsPerShell;
+
+	// the shells, sorted by the radius
+	TArray<FSphereHordeLatticeShell>	Shells;
+
+	// builds the jittered spiral of the radius and drops the points closer than the minimum distance to the kept ones
+	void	BuildShell(float Radius, FRandomStream& Stream, FSphereHordeLatticeShell& OutShell) const;
+};
@@ -0,0 +1,325 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeMovingHorde.h"
+#include "SphereHordeGameMode.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Particles/ParticleSystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/AssetManager.h"
+#include "Async/ParallelFor.h"
+
+// Sets default values
+ASphereHordeMovingHorde::ASphereHordeMovingHorde()
+{
+	// the horde is moved every frame
+	PrimaryActorTick.bCanEverTick = true;
+
+	// create the instanced mesh and set it as the root component, the horde stays at the origin
+	// and the instance transforms are written in world space
+	HordeInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Horde Instances"));
+	HordeInstances->SetCollisionProfileName("Pawn");
+	HordeInstances->SetMobility(EComponentMobility::Movable);
+	SetRootComponent(HordeInstances);
+
+	// the cells are listed on the first query
+	bAreLocationCellsDirty = true;
+	LocationCellSize = 500.f;
+}
+
+// Called when the game starts or when spawned
+void ASphereHordeMovingHorde::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// stream the destruction vfx, so it is not loaded on the first kill
+	if (!DestructionParticle.IsNull())
+	{
+		DestructionParticleHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(DestructionParticle.ToSoftObjectPath());
+	}
+}
+
+// Called every frame
+void ASphereHordeMovingHorde::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// the horde follows the pawn of the soak bot if it plays instead of the player
+	ASphereHordeGameMode* GameMode = GetWorld()->GetAuthGameMode<ASphereHordeGameMode>();
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	APawn* PlayerPawn = GameMode ? GameMode->GetHordePawn() : (PlayerController ? PlayerController->GetPawn() : nullptr);
+	if (!PlayerPawn || Locations.Num() == 0)
+	{
+		return;
+	}
+
+	UpdateTargets(DeltaTime, PlayerPawn->GetActorLocation());
+	bAreLocationCellsDirty = true;
+
+	// write all the transforms back at once
+	HordeInstances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true, true);
+}
+
+// moves all the targets by DeltaTime relatively to the player location and fills the instance transforms,
+// every target is independent from the others, so the pass is split between the worker threads for big hordes
+void ASphereHordeMovingHorde::UpdateTargets(float DeltaTime, const FVector& PlayerLocation)
+{
+	const int32 TargetsNb = Locations.Num();
+	InstanceTransforms.SetNum(TargetsNb, false);
+
+	FVector* LocationsData = Locations.GetData();
+	const float* SpeedsData = Speeds.GetData();
+	const float* ScalesData = Scales.GetData();
+	FTransform* TransformsData = InstanceTransforms.GetData();
+
+	const EHordeMovementMode Mode = MovementMode;
+	const float StopDistance = MinDistanceToPlayer;
+
+	ParallelFor(TargetsNb, [=](int32 Index)
+	{
+		FVector& Location = LocationsData[Index];
+
+		if (Mode == EHordeMovementMode::Drift)
+		{
+			// move towards the player, but not closer than the stop distance
+			const FVector ToPlayer = PlayerLocation - Location;
+			const float Distance = ToPlayer.Size();
+			if (Distance > StopDistance)
+			{
+				const float Step = FMath::Min(SpeedsData[Index] * DeltaTime, Distance - StopDistance);
+				Location += ToPlayer * (Step / Distance);
+			}
+		}
+		else
+		{
+			// rotate the offset from the player around the vertical axis, the height is kept
+			float Sin, Cos;
+			FMath::SinCos(&Sin, &Cos, FMath::DegreesToRadians(SpeedsData[Index] * DeltaTime));
+			const float OffsetX = Location.X - PlayerLocation.X;
+			const float OffsetY = Location.Y - PlayerLocation.Y;
+			Location.X = PlayerLocation.X + OffsetX * Cos - OffsetY * Sin;
+			Location.Y = PlayerLocation.Y + OffsetX * Sin + OffsetY * Cos;
+		}
+
+		TransformsData[Index] = FTransform(FQuat::Identity, Location, FVector(ScalesData[Index]));
+	}, TargetsNb < ParallelUpdateThreshold);
+}
+
+// adds a target to the horde, the target keeps its wave and shell tags
+void ASphereHordeMovingHorde::AddTarget(const FVector& Location, float Scale, int32 WaveId, ESphereTargetShell Shell)
+{
+	Locations.Add(Location);
+	Speeds.Add(SpeedStream.FRandRange(MinSpeed, MaxSpeed));
+	Scales.Add(Scale);
+	WaveIds.Add(WaveId);
+	Shells.Add(Shell);
+	bAreLocationCellsDirty = true;
+
+	HordeInstances->AddInstanceWorldSpace(FTransform(FQuat::Identity, Location, FVector(Scale)));
+}
+
+// removes all the targets without counting them as kills
+void	ASphereHordeMovingHorde::Reset()
+{
+	Locations.Reset();
+	Speeds.Reset();
+	Scales.Reset();
+	WaveIds.Reset();
+	Shells.Reset();
+	InstanceTransforms.Reset();
+	bAreLocationCellsDirty = true;
+
+	HordeInstances->ClearInstances();
+}
+
+// adds the records of the targets at their current locations
+void	ASphereHordeMovingHorde::AppendRecords(TArray<FSphereTargetRecord>& OutRecords) const
+{
+	OutRecords.Reserve(OutRecords.Num() + Locations.Num());
+	for (int32 Index = 0; Index < Locations.Num(); Index++)
+	{
+		FSphereTargetRecord& Record = OutRecords.AddDefaulted_GetRef();
+		Record.Location = Locations[Index];
+		Record.Scale = Scales[Index];
+		Record.WaveId = WaveIds[Index];
+		Record.Shell = Shells[Index];
+	}
+}
+
+// seeds the random stream the speeds of the targets are picked from
+void	ASphereHordeMovingHorde::SetRandomSeed(int32 Seed)
+{
+	SpeedStream.Initialize(Seed);
+}
+
+// destroys the target by the index of its instance, plays the vfx and counts the kill in the game mode
+// the instanced mesh keeps the order of the instances on removal, so the arrays keep it as well
+void ASphereHordeMovingHorde::KillTarget(int32 InstanceIndex)
+{
+	if (!Locations.IsValidIndex(InstanceIndex))
+	{
+		return;
+	}
+
+	const int32 WaveId = WaveIds[InstanceIndex];
+	const ESphereTargetShell Shell = Shells[InstanceIndex];
+	const FVector Location = Locations[InstanceIndex];
+
+	ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	PlayDeathEffects(Location, GameMode);
+
+	Locations.RemoveAt(InstanceIndex, 1, false);
+	Speeds.RemoveAt(InstanceIndex, 1, false);
+	Scales.RemoveAt(InstanceIndex, 1, false);
+	WaveIds.RemoveAt(InstanceIndex, 1, false);
+	Shells.RemoveAt(InstanceIndex, 1, false);
+	HordeInstances->RemoveInstance(InstanceIndex);
+	bAreLocationCellsDirty = true;
+
+	if (GameMode)
+	{
+		GameMode->UpdatedNubmerOfDestroyedSpheres(WaveId, Shell, Location);
+	}
+}
+
+// destroys all the targets within Radius of Center and adds their tags to OutKills
+int32 ASphereHordeMovingHorde::KillTargetsInRadius(const FVector& Center, float Radius, int32 MaxVfxNb, FSphereTargetKillArray& OutKills)
+{
+	ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+
+	// the locations are packed, so one linear pass over them is cheaper than a spatial query,
+	// the kept targets are moved down over the killed ones in the same pass, so the order of the instances is kept
+	const float RadiusSquared = FMath::Square(Radius);
+	const int32 TargetsNb = Locations.Num();
+	InstanceTransforms.SetNum(TargetsNb, false);
+	int32 KeptTargetsNb = 0;
+	for (int32 Index = 0; Index < TargetsNb; Index++)
+	{
+		if (FVector::DistSquared(Locations[Index], Center) <= RadiusSquared)
+		{
+			// the targets before this one are either kept or killed already
+			if (Index - KeptTargetsNb < MaxVfxNb)
+			{
+				PlayDeathEffects(Locations[Index], GameMode);
+			}
+			OutKills.Add({ Locations[Index], WaveIds[Index], Shells[Index] });
+			continue;
+		}
+
+		if (KeptTargetsNb != Index)
+		{
+			Locations[KeptTargetsNb] = Locations[Index];
+			Speeds[KeptTargetsNb] = Speeds[Index];
+			Scales[KeptTargetsNb] = Scales[Index];
+			WaveIds[KeptTargetsNb] = WaveIds[Index];
+			Shells[KeptTargetsNb] = Shells[Index];
+		}
+		InstanceTransforms[KeptTargetsNb] = FTransform(FQuat::Identity, Locations[KeptTargetsNb], FVector(Scales[KeptTargetsNb]));
+		KeptTargetsNb++;
+	}
+
+	const int32 KilledTargetsNb = TargetsNb - KeptTargetsNb;
+	if (KilledTargetsNb == 0)
+	{
+		return 0;
+	}
+
+	Locations.SetNum(KeptTargetsNb, false);
+	Speeds.SetNum(KeptTargetsNb, false);
+	Scales.SetNum(KeptTargetsNb, false);
+	WaveIds.SetNum(KeptTargetsNb, false);
+	Shells.SetNum(KeptTargetsNb, false);
+	InstanceTransforms.SetNum(KeptTargetsNb, false);
+
+	// the kept instances take the transforms of the targets moved down in one batch, and the instances left over at the end are removed
+	RemovedInstances.Reset();
+	for (int32 Index = TargetsNb - 1; Index >= KeptTargetsNb; Index--)
+	{
+		RemovedInstances.Add(Index);
+	}
+	HordeInstances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, false, true);
+	HordeInstances->RemoveInstances(RemovedInstances);
+	bAreLocationCellsDirty = true;
+
+	return KilledTargetsNb;
+}
+
+// plays the pooled destruction vfx at Location
+void ASphereHordeMovingHorde::PlayDeathEffects(const FVector& Location, ASphereHordeGameMode* GameMode)
+{
+	// play destruction vfx if the DestructionParticle particle system is loaded and the game is not over its frame budget
+	UParticleSystem* LoadedDestructionParticle = DestructionParticle.Get();
+	if (LoadedDestructionParticle && (!GameMode || GameMode->ShouldPlayDestructionVfx()))
+	{
+		// the finished emitters are returned to the pool of the world instead of being destroyed
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), LoadedDestructionParticle, Location, FRotator::ZeroRotator, FVector(1.f), true, EPSCPoolMethod::AutoRelease);
+	}
+}
+
+// get the number of the targets in the horde
+int32 ASphereHordeMovingHorde::GetTargetsNb() const
+{
+	return Locations.Num();
+}
+
+// checks if any target of the horde has its center closer than the distance to the location
+bool ASphereHordeMovingHorde::IsAnyTargetWithin(const FVector& Location, float Distance) const
+{
+	if (Locations.Num() == 0)
+	{
+		return false;
+	}
+
+	if (bAreLocationCellsDirty)
+	{
+		UpdateLocationCells();
+	}
+
+	const float DistanceSquared = FMath::Square(Distance);
+	const FIntVector MinCell = GetLocationCell(Location - FVector(Distance));
+	const FIntVector MaxCell = GetLocationCell(Location + FVector(Distance));
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+			{
+				const TArray<int32>* CellTargets = LocationCells.Find(FIntVector(X, Y, Z));
+				if (!CellTargets)
+				{
+					continue;
+				}
+
+				for (int32 Index : *CellTargets)
+				{
+					if (FVector::DistSquared(Locations[Index], Location) < DistanceSquared)
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+// lists the targets in the cells of their current locations
+void ASphereHordeMovingHorde::UpdateLocationCells() const
+{
+	LocationCells.Reset();
+	for (int32 Index = 0; Index < Locations.Num(); Index++)
+	{
+		LocationCells.FindOrAdd(GetLocationCell(Locations[Index])).Add(Index);
+	}
+	bAreLocationCellsDirty = false;
+}
+
+// get the cell the point is in
+FIntVector ASphereHordeMovingHorde::GetLocationCell(const FVector& Point) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Point.X / LocationCellSize),
+		FMath::FloorToInt(Point.Y / LocationCellSize),
+		FMath::FloorToInt(Point.Z / LocationCellSize));
+}
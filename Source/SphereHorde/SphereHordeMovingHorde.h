@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Engine/StreamableManager.h"
+#include "SphereTarget.h"
+#include "SphereHordeSnapshot.h"
+#include "SphereHordeMovingHorde.generated.h"
+
+class UInstancedStaticMeshComponent;
+class UParticleSystem;
+class ASphereHordeGameMode;
+
+// the way the targets of the moving horde move relatively to the player
+UENUM()
+enum class EHordeMovementMode : uint8
+{
+	// the targets drift towards the player and stop at some distance from it
+	Drift,
+	// the targets orbit the player around the vertical axis
+	Orbit
+};
+
+/*
+	define the actor that moves the targets of the horde as the instances of one instanced mesh,
+	the kinematics of the targets are stored in contiguous arrays and are updated in one batched pass per frame,
+	the transforms are written back to the instanced mesh at once
+
+	1. movement mode and speed range of the targets
+	2. distance from the player where the drifting targets stop
+	3. vfx when the target is destroyed
+*/
+
+UCLASS()
+class SPHEREHORDE_API ASphereHordeMovingHorde : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ASphereHordeMovingHorde();
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	// adds a target to the horde, the target keeps its wave and shell tags
+	void	AddTarget(const FVector& Location, float Scale, int32 WaveId, ESphereTargetShell Shell);
+
+	// seeds the random stream the speeds of the targets are picked from
+	void	SetRandomSeed(int32 Seed);
+
+	// destroys the target by the index of its instance, plays the vfx and counts the kill in the game mode
+	void	KillTarget(int32 InstanceIndex);
+
+	// destroys all the targets within Radius of Center and adds their tags to OutKills, the caller counts them in the game mode,
+	// the vfx is played for MaxVfxNb targets at most, returns the number of the destroyed targets
+	int32	KillTargetsInRadius(const FVector& Center, float Radius, int32 MaxVfxNb, FSphereTargetKillArray& OutKills);
+
+	// removes all the targets without counting them as kills, the snapshot restore places them again
+	void	Reset();
+
+	// adds the records of the targets at their current locations, so the snapshot keeps the moving targets
+	void	AppendRecords(TArray<FSphereTargetRecord>& OutRecords) const;
+
+	// get the number of the targets in the horde
+	int32	GetTargetsNb() const;
+
+	// checks if any target of the horde has its center closer than the distance to the location, at the locations of this frame,
+	// the spawner keeps the new waves apart from the moving targets with it, the targets may still meet each other as they move
+	bool	IsAnyTargetWithin(const FVector& Location, float Distance) const;
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// the instanced mesh that renders the targets and that is hit by the projectiles
+	UPROPERTY(VisibleAnywhere)
+	UInstancedStaticMeshComponent* HordeInstances;
+
+	// the way the targets move relatively to the player
+	UPROPERTY(EditDefaultsOnly, Category = "Movement")
+	EHordeMovementMode	MovementMode = EHordeMovementMode::Drift;
+
+	// the speed of the targets, in units per second for the drift and in degrees per second for the orbit
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0"), Category = "Movement")
+	float	MinSpeed = 50.f;
+
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0"), Category = "Movement")
+	float	MaxSpeed = 150.f;
+
+	// the distance from the player where the drifting targets stop
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0"), Category = "Movement")
+	float	MinDistanceToPlayer = 300.f;
+
+	// the number of the targets below it the horde is moved on the game thread only
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "1"), Category = "Movement")
+	int32	ParallelUpdateThreshold = 256;
+
+	// particle system for the vfx when the target is destroyed, it is loaded asynchronously on begin play
+	UPROPERTY(EditDefaultsOnly, Category = "Vfx")
+	TSoftObjectPtr<UParticleSystem>	DestructionParticle;
+
+private:
+	// the kinematics and the tags of the targets, the index in the arrays is the index of the instance
+	TArray<FVector>				Locations;
+	TArray<float>				Speeds;
+	TArray<float>				Scales;
+	TArray<int32>				WaveIds;
+	TArray<ESphereTargetShell>	Shells;
+
+	// the random stream the speeds are picked from, seeded by the spawner so the replays move the same way
+	FRandomStream	SpeedStream;
+
+	// the transforms written to the instanced mesh, kept between the frames to avoid the allocations
+	TArray<FTransform>			InstanceTransforms;
+
+	// the instances removed by a blast, kept between the blasts to avoid the allocations
+	TArray<int32>				RemovedInstances;
+
+	// the handle that keeps the destruction vfx in memory
+	TSharedPtr<FStreamableHandle>	DestructionParticleHandle;
+
+	// the indices of the targets listed in each non-empty cell, rebuilt by the first query after the targets moved,
+	// so the frames without the queries do not pay for it
+	mutable TMap<FIntVector, TArray<int32>>	LocationCells;
+	mutable bool	bAreLocationCellsDirty;
+
+	// the size of a cell, in world units
+	float	LocationCellSize;
+
+	// lists the targets in the cells of their current locations
+	void	UpdateLocationCells() const;
+
+	// get the cell the point is in
+	FIntVector	GetLocationCell(const FVector& Point) const;
+
+	// moves all the targets by DeltaTime relatively to the player location and fills the instance transforms
+	void	UpdateTargets(float DeltaTime, const FVector& PlayerLocation);
+
+	// plays the pooled destruction vfx at Location if it is loaded and the game is not over its frame budget
+	void	PlayDeathEffects(const FVector& Location, ASphereHordeGameMode* GameMode);
+};
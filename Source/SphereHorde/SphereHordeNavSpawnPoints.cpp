@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeNavSpawnPoints.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavMesh/RecastNavMesh.h"
+#include "GameFramework/Pawn.h"
+
+// the size of the grid cells the points are cached in if the navmesh is not a recast one
+static const float	NavSpawnPointsFallbackTileSize = 1000.f;
+
+USphereHordeNavSpawnPoints::USphereHordeNavSpawnPoints()
+{
+	MaxPointsPerTile = 16;
+	MaxPendingQueries = 32;
+}
+
+// binds to the navmesh rebuilds, the cache is dropped when the navmesh changes
+void	USphereHordeNavSpawnPoints::Initialize(int32 InMaxPointsPerTile)
+{
+	MaxPointsPerTile = FMath::Max(InMaxPointsPerTile, 1);
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (NavSys)
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &USphereHordeNavSpawnPoints::OnNavigationGenerationFinished);
+	}
+}
+
+// issues up to QueriesBudget queries for the points in the box around the pawn, until DesiredPointsNb points are cached there
+void	USphereHordeNavSpawnPoints::RequestPoints(const APawn* Pawn, const FVector& BoxExtent, int32 QueriesBudget, int32 DesiredPointsNb, FRandomStream& Stream)
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	if (!Pawn || !NavData)
+	{
+		return;
+	}
+
+	const FVector Origin = Pawn->GetActorLocation();
+	if (CountPoints(Origin, BoxExtent) >= DesiredPointsNb)
+	{
+		return;
+	}
+
+	// the paths start from the pawn position on the navmesh
+	FNavLocation PawnNavLocation;
+	if (!NavSys->ProjectPointToNavigation(Origin, PawnNavLocation, FVector(0.f, 0.f, BoxExtent.Z)))
+	{
+		return;
+	}
+
+	const FVector QueryExtent(100.f, 100.f, BoxExtent.Z);
+	for (int32 i = 0; i < QueriesBudget && PendingQueries.Num() < MaxPendingQueries; i++)
+	{
+		// the candidate is projected to the navmesh, the projection is a cheap local query, unlike the pathfinding
+		const FVector Candidate(
+			Stream.FRandRange(Origin.X - BoxExtent.X, Origin.X + BoxExtent.X),
+			Stream.FRandRange(Origin.Y - BoxExtent.Y, Origin.Y + BoxExtent.Y),
+			Origin.Z);
+
+		FNavLocation CandidateNavLocation;
+		if (!NavSys->ProjectPointToNavigation(Candidate, CandidateNavLocation, QueryExtent))
+		{
+			continue;
+		}
+
+		const FIntPoint Tile = GetTile(NavData, CandidateNavLocation.Location);
+		const FNavTilePoints* CachedTile = TilePoints.Find(Tile);
+		if (CachedTile && CachedTile->Points.Num() >= MaxPointsPerTile)
+		{
+			continue;
+		}
+
+		FPathFindingQuery Query(this, *NavData, PawnNavLocation.Location, CandidateNavLocation.Location);
+		const uint32 QueryId = NavSys->FindPathAsync(Pawn->GetNavAgentPropertiesRef(), Query,
+			FNavPathQueryDelegate::CreateUObject(this, &USphereHordeNavSpawnPoints::OnPathFound));
+		if (QueryId != INVALID_NAVQUERYID)
+		{
+			PendingQueries.Add(QueryId, { CandidateNavLocation.Location, Tile });
+		}
+	}
+}
+
+// caches the point if the path to it is found
+void	USphereHordeNavSpawnPoints::OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	FPendingNavQuery PendingQuery;
+	if (!PendingQueries.RemoveAndCopyValue(QueryId, PendingQuery))
+	{
+		return;
+	}
+
+	// the partial path ends somewhere else, the point is not reachable
+	if (Result != ENavigationQueryResult::Success || !Path.IsValid() || Path->IsPartial())
+	{
+		return;
+	}
+
+	FNavTilePoints& CachedTile = TilePoints.FindOrAdd(PendingQuery.Tile);
+	if (CachedTile.Points.Num() < MaxPointsPerTile)
+	{
+		CachedTile.Points.Add(PendingQuery.Point);
+	}
+}
+
+// drops the cache, the points may not be reachable anymore
+void	USphereHordeNavSpawnPoints::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	TilePoints.Reset();
+	PendingQueries.Reset();
+}
+
+// get the tile the point belongs to, the navmesh tile if the navmesh is a recast one, the cell of the fixed grid otherwise
+FIntPoint	USphereHordeNavSpawnPoints::GetTile(const ANavigationData* NavData, const FVector& Point) const
+{
+	const ARecastNavMesh* NavMesh = Cast<const ARecastNavMesh>(NavData);
+	FIntPoint Tile;
+	if (NavMesh && NavMesh->GetNavMeshTileXY(Point, Tile.X, Tile.Y))
+	{
+		return Tile;
+	}
+
+	return FIntPoint(FMath::FloorToInt(Point.X / NavSpawnPointsFallbackTileSize), FMath::FloorToInt(Point.Y / NavSpawnPointsFallbackTileSize));
+}
+
+// visits the cached points of the tiles the box overlaps
+template <typename FunctionType>
+void	USphereHordeNavSpawnPoints::ForEachTileInBox(const FVector& Origin, const FVector& BoxExtent, FunctionType Function) const
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+
+	const FIntPoint MinTile = GetTile(NavData, Origin - BoxExtent);
+	const FIntPoint MaxTile = GetTile(NavData, Origin + BoxExtent);
+	for (int32 TileY = FMath::Min(MinTile.Y, MaxTile.Y); TileY <= FMath::Max(MinTile.Y, MaxTile.Y); TileY++)
+	{
+		for (int32 TileX = FMath::Min(MinTile.X, MaxTile.X); TileX <= FMath::Max(MinTile.X, MaxTile.X); TileX++)
+		{
+			if (const FNavTilePoints* CachedTile = TilePoints.Find(FIntPoint(TileX, TileY)))
+			{
+				Function(*CachedTile);
+			}
+		}
+	}
+}
+
+// collects the cached points in the box
+void	USphereHordeNavSpawnPoints::GatherPoints(const FVector& Origin, const FVector& BoxExtent, TArray<FVector>& OutPoints) const
+{
+	const FBox Box(Origin - BoxExtent, Origin + BoxExtent);
+	ForEachTileInBox(Origin, BoxExtent, [&Box, &OutPoints](const FNavTilePoints& CachedTile)
+	{
+		for (const FVector& Point : CachedTile.Points)
+		{
+			if (Box.IsInside(Point))
+			{
+				OutPoints.Add(Point);
+			}
+		}
+	});
+}
+
+// get the number of the cached points in the box
+int32	USphereHordeNavSpawnPoints::CountPoints(const FVector& Origin, const FVector& BoxExtent) const
+{
+	const FBox Box(Origin - BoxExtent, Origin + BoxExtent);
+	int32 PointsNb = 0;
+	ForEachTileInBox(Origin, BoxExtent, [&Box, &PointsNb](const FNavTilePoints& CachedTile)
+	{
+		for (const FVector& Point : CachedTile.Points)
+		{
+			PointsNb += Box.IsInside(Point) ? 1 : 0;
+		}
+	});
+	return PointsNb;
+}
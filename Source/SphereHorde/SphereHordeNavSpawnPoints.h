@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "SphereHordeNavSpawnPoints.generated.h"
+
+class ANavigationData;
+class APawn;
+
+/*
+	define the cache of the spawn points reachable from the pawn, the points are taken from the navigation system
+
+	1. the candidate points are picked in the spawn box and projected to the navmesh
+	2. the path from the pawn to each of them is found by the asynchronous pathfinding, a few queries per frame
+	3. the reachable points are cached per navmesh tile, the spawner only reads the cache, so it never waits for the pathfinding
+*/
+
+UCLASS()
+class SPHEREHORDE_API USphereHordeNavSpawnPoints : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	USphereHordeNavSpawnPoints();
+
+	// binds to the navmesh rebuilds, the cache is dropped when the navmesh changes
+	void	Initialize(int32 InMaxPointsPerTile);
+
+	// issues up to QueriesBudget queries for the points in the box around the pawn, until DesiredPointsNb points are cached there
+	void	RequestPoints(const APawn* Pawn, const FVector& BoxExtent, int32 QueriesBudget, int32 DesiredPointsNb, FRandomStream& Stream);
+
+	// collects the cached points in the box, the points are on the navmesh, without any height offset
+	void	GatherPoints(const FVector& Origin, const FVector& BoxExtent, TArray<FVector>& OutPoints) const;
+
+	// get the number of the cached points in the box
+	int32	CountPoints(const FVector& Origin, const FVector& BoxExtent) const;
+
+private:
+	// the reachable points of one navmesh tile
+	struct FNavTilePoints
+	{
+		TArray<FVector>	Points;
+	};
+
+	// the candidate point waiting for its path query
+	struct FPendingNavQuery
+	{
+		FVector		Point;
+		FIntPoint	Tile;
+	};
+
+	// the cached reachable points, per navmesh tile
+	TMap<FIntPoint, FNavTilePoints>	TilePoints;
+
+	// the path queries in flight, by the query id
+	TMap<uint32, FPendingNavQuery>	PendingQueries;
+
+	// the maximum number of the points cached per tile
+	int32	MaxPointsPerTile;
+
+	// the maximum number of the path queries in flight
+	int32	MaxPendingQueries;
+
+	// get the tile the point belongs to, the navmesh tile if the navmesh is a recast one, the cell of the fixed grid otherwise
+	FIntPoint	GetTile(const ANavigationData* NavData, const FVector& Point) const;
+
+	// visits the cached points of the tiles the box overlaps
+	template <typename FunctionType>
+	void	ForEachTileInBox(const FVector& Origin, const FVector& BoxExtent, FunctionType Function) const;
+
+	// caches the point if the path to it is found
+	void	OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	// drops the cache, the points may not be reachable anymore
+	UFUNCTION()
+	void	OnNavigationGenerationFinished(ANavigationData* NavData);
+};
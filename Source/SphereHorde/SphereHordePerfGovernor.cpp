@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordePerfGovernor.h"
+
+FSphereHordePerfGovernor::FSphereHordePerfGovernor()
+{
+	SmoothedFrameMs = 0.f;
+	SmoothedGameThreadMs = 0.f;
+	VfxAccumulator = 0.f;
+}
+
+// sets the budget and drops the measured times
+void	FSphereHordePerfGovernor::Initialize(const FSphereHordePerfBudget& InBudget)
+{
+	Budget = InBudget;
+	SmoothedFrameMs = 0.f;
+	SmoothedGameThreadMs = 0.f;
+	VfxAccumulator = 0.f;
+}
+
+// adds the times of the frame to the smoothed times, the first frame sets them as they are
+void	FSphereHordePerfGovernor::AddFrame(float FrameMs, float GameThreadMs)
+{
+	if (SmoothedFrameMs <= 0.f)
+	{
+		SmoothedFrameMs = FrameMs;
+		SmoothedGameThreadMs = GameThreadMs;
+		return;
+	}
+
+	SmoothedFrameMs = FMath::Lerp(SmoothedFrameMs, FrameMs, Budget.SmoothingWeight);
+	SmoothedGameThreadMs = FMath::Lerp(SmoothedGameThreadMs, GameThreadMs, Budget.SmoothingWeight);
+}
+
+// get the load, the largest ratio of the smoothed times to the budget
+float	FSphereHordePerfGovernor::GetLoad() const
+{
+	if (!Budget.bAdaptiveWaveScaling)
+	{
+		return 0.f;
+	}
+
+	return FMath::Max(SmoothedFrameMs / Budget.TargetFrameMs, SmoothedGameThreadMs / Budget.TargetGameThreadMs);
+}
+
+// get the number of actors of the next wave
+int32	FSphereHordePerfGovernor::LimitActorsNb(int32 CurrentActorsNb, int32 GrownActorsNb, int32 MinActorsNb) const
+{
+	const float Load = GetLoad();
+	if (Load <= Budget.FullGrowthLoad || GrownActorsNb <= CurrentActorsNb)
+	{
+		return GrownActorsNb;
+	}
+
+	// over budget the wave shrinks in proportion to the load
+	if (Load >= 1.f)
+	{
+		return FMath::Max(FMath::FloorToInt(CurrentActorsNb / Load), MinActorsNb);
+	}
+
+	// near the budget the growth fades out
+	const float GrowthShare = (1.f - Load) / (1.f - Budget.FullGrowthLoad);
+	return CurrentActorsNb + FMath::FloorToInt((GrownActorsNb - CurrentActorsNb) * GrowthShare);
+}
+
+// get the share of the destruction vfx to play, all of them under budget, down to the minimum at twice the budget
+float	FSphereHordePerfGovernor::GetVfxDensity() const
+{
+	const float Load = GetLoad();
+	if (Load <= 1.f)
+	{
+		return 1.f;
+	}
+
+	return FMath::Clamp(2.f - Load, Budget.MinVfxDensity, 1.f);
+}
+
+// checks if the next destruction vfx is to be played
+bool	FSphereHordePerfGovernor::ShouldPlayVfx()
+{
+	VfxAccumulator += GetVfxDensity();
+	if (VfxAccumulator >= 1.f)
+	{
+		VfxAccumulator -= 1.f;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SphereHordePerfGovernor.generated.h"
+
+/*
+	define the budget the waves are scaled against, the governor compares the smoothed frame
+	and game thread times with it, the load is the largest of the two ratios
+
+	1. the frame and game thread times to keep
+	2. the load below which the waves grow at the full rate
+	3. the minimum share of the destruction vfx played when over budget
+*/
+
+USTRUCT()
+struct FSphereHordePerfBudget
+{
+	GENERATED_BODY()
+
+	// scales the waves by the measured times, the growth is not limited if it is turned off
+	UPROPERTY(EditDefaultsOnly)
+	bool	bAdaptiveWaveScaling = true;
+
+	// the frame time to keep, in milliseconds
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "4.0", ClampMax = "100.0", UIMin = "4.0", UIMax = "100.0"))
+	float	TargetFrameMs = 16.67f;
+
+	// the game thread time to keep, in milliseconds
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "2.0", ClampMax = "100.0", UIMin = "2.0", UIMax = "100.0"))
+	float	TargetGameThreadMs = 12.f;
+
+	// the share of the budget below which the waves grow at the full rate, the growth fades out between it and the budget
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.1", ClampMax = "0.95", UIMin = "0.1", UIMax = "0.95"))
+	float	FullGrowthLoad = 0.8f;
+
+	// the weight of the new frame in the smoothed times, the smaller the weight the more frames are averaged
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.01", ClampMax = "1.0", UIMin = "0.01", UIMax = "1.0"))
+	float	SmoothingWeight = 0.05f;
+
+	// the minimum share of the destruction vfx that are played when over budget
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
+	float	MinVfxDensity = 0.25f;
+};
+
+// watches the frame and game thread times and limits the growth of the waves and the vfx density by them
+class FSphereHordePerfGovernor
+{
+public:
+	FSphereHordePerfGovernor();
+
+	// sets the budget and drops the measured times
+	void	Initialize(const FSphereHordePerfBudget& InBudget);
+
+	// adds the times of the frame to the smoothed times
+	void	AddFrame(float FrameMs, float GameThreadMs);
+
+	// get the load, the largest ratio of the smoothed times to the budget, 1 is the budget
+	float	GetLoad() const;
+
+	// get the number of actors of the next wave, the full growth with headroom, less growth near the budget,
+	// and less actors than in the current wave over budget
+	int32	LimitActorsNb(int32 CurrentActorsNb, int32 GrownActorsNb, int32 MinActorsNb) const;
+
+	// get the share of the destruction vfx to play
+	float	GetVfxDensity() const;
+
+	// checks if the next destruction vfx is to be played, the vfx are skipped evenly to keep the density
+	bool	ShouldPlayVfx();
+
+private:
+	FSphereHordePerfBudget	Budget;
+
+	// the smoothed frame and game thread times, in milliseconds, 0 until the first frame is measured
+	float	SmoothedFrameMs;
+	float	SmoothedGameThreadMs;
+
+	// the accumulated vfx density, a vfx is played each time it reaches 1
+	float	VfxAccumulator;
+};
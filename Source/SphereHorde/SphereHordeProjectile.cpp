@@ -3,6 +3,7 @@
 #include "SphereHordeProjectile.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "SphereTarget.h"
+#include "SphereHordeMovingHorde.h"
 #include "Components/SphereComponent.h"
 
 ASphereHordeProjectile::ASphereHordeProjectile() 
@@ -30,10 +31,20 @@ ASphereHordeProjectile::ASphereHordeProjectile()
 
 	// Die after 3 seconds by default
 	InitialLifeSpan = 3.0f;
+
+	// the server resolves the hits, the clients see the replicated projectile
+	bReplicates = true;
+	SetReplicateMovement(true);
 }
 
 void ASphereHordeProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
+	// the targets exist on the server only
+	if (!HasAuthority())
+	{
+		return;
+	}
+
 	// check if the actor we hit is a SphereTarget objects
 	ASphereTarget* SphereTargetHit = Cast<ASphereTarget>(OtherActor);
 	// destroy the projectile and the target only if we hit the SphereTarget object
@@ -41,5 +52,14 @@ void ASphereHordeProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherAc
 	{
 		Destroy();
 		SphereTargetHit->PlayDeathEffectsAndDestroy();
+		return;
+	}
+
+	// the targets of the moving horde are the instances of its instanced mesh, the hit item is the instance index
+	ASphereHordeMovingHorde* MovingHordeHit = Cast<ASphereHordeMovingHorde>(OtherActor);
+	if (MovingHordeHit && Hit.Item != INDEX_NONE)
+	{
+		Destroy();
+		MovingHordeHit->KillTarget(Hit.Item);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeReplicatedHorde.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Net/UnrealNetwork.h"
+
+// adds the instance of the target on the client
+void	FSphereTargetNetItem::PostReplicatedAdd(const FSphereTargetNetArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnTargetAdded(*this);
+	}
+}
+
+// hides the instance of the killed target on the client
+void	FSphereTargetNetItem::PreReplicatedRemove(const FSphereTargetNetArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnTargetRemoved(*this);
+	}
+}
+
+// Sets default values
+ASphereHordeReplicatedHorde::ASphereHordeReplicatedHorde()
+{
+	// the horde does not change by itself, it is not ticked
+	PrimaryActorTick.bCanEverTick = false;
+
+	// the horde is one actor for all the clients, it is always relevant and dormant until it changes
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	NetDormancy = DORM_DormantAll;
+
+	// the instances are only visual, the projectiles hit the target actors on the server
+	HordeInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Horde Instances"));
+	HordeInstances->SetCollisionProfileName("NoCollision");
+	SetRootComponent(HordeInstances);
+
+	DestroyedSpheres = 0;
+	CurrentWaveNumber = 1;
+	NextTargetId = 0;
+	Targets.Owner = this;
+}
+
+// Called when the game starts or when spawned
+void ASphereHordeReplicatedHorde::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Targets.Owner = this;
+}
+
+void ASphereHordeReplicatedHorde::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ASphereHordeReplicatedHorde, Targets);
+	DOREPLIFETIME(ASphereHordeReplicatedHorde, DestroyedSpheres);
+	DOREPLIFETIME(ASphereHordeReplicatedHorde, CurrentWaveNumber);
+}
+
+// wakes the dormant actor up to replicate the changes, it goes dormant again after that
+void ASphereHordeReplicatedHorde::MarkHordeChanged()
+{
+	FlushNetDormancy();
+}
+
+// adds the target to the replicated horde on the server and returns its id
+int32 ASphereHordeReplicatedHorde::AddTarget(const FVector& Location, float Scale)
+{
+	FSphereTargetNetItem& Item = Targets.Items.AddDefaulted_GetRef();
+	Item.TargetId = NextTargetId++;
+	Item.Location = Location;
+	Item.QuantizedScale = (uint8)FMath::Clamp(FMath::RoundToInt(Scale * 100.f), 1, 255);
+
+	ItemIndexByTargetId.Add(Item.TargetId, Targets.Items.Num() - 1);
+	Targets.MarkItemDirty(Item);
+	MarkHordeChanged();
+
+	return Item.TargetId;
+}
+
+// removes the target from the replicated horde on the server, the last item takes its place
+void ASphereHordeReplicatedHorde::RemoveTarget(int32 TargetId)
+{
+	int32 ItemIndex = INDEX_NONE;
+	if (!ItemIndexByTargetId.RemoveAndCopyValue(TargetId, ItemIndex))
+	{
+		return;
+	}
+
+	Targets.Items.RemoveAtSwap(ItemIndex, 1, false);
+	if (Targets.Items.IsValidIndex(ItemIndex))
+	{
+		ItemIndexByTargetId.Add(Targets.Items[ItemIndex].TargetId, ItemIndex);
+	}
+	Targets.MarkArrayDirty();
+	MarkHordeChanged();
+}
+
+// updates the replicated score and wave number on the server
+void ASphereHordeReplicatedHorde::SetScore(int32 InDestroyedSpheres, int32 InCurrentWaveNumber)
+{
+	DestroyedSpheres = InDestroyedSpheres;
+	CurrentWaveNumber = InCurrentWaveNumber;
+	MarkHordeChanged();
+}
+
+// broadcasts the replicated score change on the client
+void ASphereHordeReplicatedHorde::OnRep_Score()
+{
+	OnScoreChanged.Broadcast(DestroyedSpheres, CurrentWaveNumber);
+}
+
+// get the replicated number of the destroyed spheres
+int32 ASphereHordeReplicatedHorde::GetDestroyedSpheres() const
+{
+	return DestroyedSpheres;
+}
+
+// get the replicated number of the current wave
+int32 ASphereHordeReplicatedHorde::GetCurrentWaveNumber() const
+{
+	return CurrentWaveNumber;
+}
+
+// adds the instance of the target on the client, the hidden instances of the killed targets are reused first
+void ASphereHordeReplicatedHorde::OnTargetAdded(const FSphereTargetNetItem& Item)
+{
+	const FTransform InstanceTransform(FQuat::Identity, Item.Location, FVector(Item.QuantizedScale / 100.f));
+
+	int32 InstanceIndex = INDEX_NONE;
+	if (FreeInstances.Num() > 0)
+	{
+		InstanceIndex = FreeInstances.Pop(false);
+		HordeInstances->UpdateInstanceTransform(InstanceIndex, InstanceTransform, true, true, true);
+	}
+	else
+	{
+		InstanceIndex = HordeInstances->AddInstanceWorldSpace(InstanceTransform);
+	}
+
+	InstanceIndexByTargetId.Add(Item.TargetId, InstanceIndex);
+}
+
+// hides the instance of the killed target on the client, the instance is not removed
+// so the indices of the other instances stay the same
+void ASphereHordeReplicatedHorde::OnTargetRemoved(const FSphereTargetNetItem& Item)
+{
+	int32 InstanceIndex = INDEX_NONE;
+	if (!InstanceIndexByTargetId.RemoveAndCopyValue(Item.TargetId, InstanceIndex))
+	{
+		return;
+	}
+
+	HordeInstances->UpdateInstanceTransform(InstanceIndex, FTransform(FQuat::Identity, Item.Location, FVector::ZeroVector), true, true, true);
+	FreeInstances.Add(InstanceIndex);
+}
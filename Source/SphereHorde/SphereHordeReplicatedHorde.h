@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Engine/NetSerialization.h"
+#include "SphereHordeGameMode.h"
+#include "SphereHordeReplicatedHorde.generated.h"
+
+class UInstancedStaticMeshComponent;
+class ASphereHordeReplicatedHorde;
+
+// the replicated state of a live target, position and scale are quantized
+USTRUCT()
+struct FSphereTargetNetItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	// the id given to the target by the horde on the server
+	UPROPERTY()
+	int32	TargetId = INDEX_NONE;
+
+	// position of the target, rounded to the whole units
+	UPROPERTY()
+	FVector_NetQuantize	Location;
+
+	// uniform scale of the target in hundredths
+	UPROPERTY()
+	uint8	QuantizedScale = 100;
+
+	// adds the instance of the target on the client
+	void	PostReplicatedAdd(const struct FSphereTargetNetArray& InArraySerializer);
+
+	// hides the instance of the killed target on the client
+	void	PreReplicatedRemove(const struct FSphereTargetNetArray& InArraySerializer);
+};
+
+// the live targets, only the added and removed items are sent to the clients
+USTRUCT()
+struct FSphereTargetNetArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FSphereTargetNetItem>	Items;
+
+	// the horde that owns the array
+	ASphereHordeReplicatedHorde*	Owner = nullptr;
+
+	bool	NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FSphereTargetNetItem, FSphereTargetNetArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FSphereTargetNetArray> : public TStructOpsTypeTraitsBase2<FSphereTargetNetArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/*
+	define the actor that replicates the horde to the clients, the target actors are not replicated,
+	the server keeps the live targets in a fast array and the clients render them as the instances of one instanced mesh
+
+	the actor is dormant, it is woken up only for the frames the horde or the score change,
+	so the server does not consider it for replication while nothing happens
+*/
+
+UCLASS()
+class SPHEREHORDE_API ASphereHordeReplicatedHorde : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ASphereHordeReplicatedHorde();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// adds the target to the replicated horde on the server and returns its id
+	int32	AddTarget(const FVector& Location, float Scale);
+
+	// removes the target from the replicated horde on the server
+	void	RemoveTarget(int32 TargetId);
+
+	// updates the replicated score and wave number on the server
+	void	SetScore(int32 InDestroyedSpheres, int32 InCurrentWaveNumber);
+
+	// get the replicated number of the destroyed spheres
+	int32	GetDestroyedSpheres() const;
+
+	// get the replicated number of the current wave
+	int32	GetCurrentWaveNumber() const;
+
+	// the event of the replicated score or wave number change on the client
+	FOnHordeScoreChanged	OnScoreChanged;
+
+	// adds or hides the instance of the target on the client
+	void	OnTargetAdded(const FSphereTargetNetItem& Item);
+	void	OnTargetRemoved(const FSphereTargetNetItem& Item);
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// the instanced mesh that renders the targets on the clients
+	UPROPERTY(VisibleAnywhere)
+	UInstancedStaticMeshComponent* HordeInstances;
+
+private:
+	// the live targets
+	UPROPERTY(Replicated)
+	FSphereTargetNetArray	Targets;
+
+	// the number of the destroyed spheres
+	UPROPERTY(ReplicatedUsing = OnRep_Score)
+	int32	DestroyedSpheres;
+
+	// the number of the current wave
+	UPROPERTY(ReplicatedUsing = OnRep_Score)
+	int32	CurrentWaveNumber;
+
+	// broadcasts the replicated score change on the client
+	UFUNCTION()
+	void	OnRep_Score();
+
+	// the id given to the next added target on the server
+	int32	NextTargetId;
+
+	// the index of the item in the fast array by the target id on the server
+	TMap<int32, int32>	ItemIndexByTargetId;
+
+	// the index of the instance by the target id on the client
+	TMap<int32, int32>	InstanceIndexByTargetId;
+
+	// the hidden instances on the client that can be reused by the next added targets
+	TArray<int32>	FreeInstances;
+
+	// wakes the dormant actor up to replicate the changes
+	void	MarkHordeChanged();
+};
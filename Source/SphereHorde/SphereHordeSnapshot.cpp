@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeSnapshot.h"
+#include "SphereHordeBinaryFile.h"
+
+// the snapshot file starts with the magic number 'SHRD' and the version
+static const FSphereHordeBinaryFormat	SphereHordeSnapshotFormat = { 0x44524853, 1 };
+
+FArchive& operator<<(FArchive& Ar, FSphereHordeSpawnerState& State)
+{
+	Ar << State.WaveId;
+	Ar << State.ActorsNb;
+	Ar << State.InnerRadiusActorsNb;
+	Ar << State.InnerSpawnRadius;
+	Ar << State.OutterSpawnRadius;
+	Ar << State.Origin;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FSphereHordeSnapshot& Snapshot)
+{
+	Ar << Snapshot.CurrentWaveNumber;
+	Ar << Snapshot.DestroyedSpheres;
+	Ar << Snapshot.SpawnerState;
+
+	// the targets are written as a flat memory block
+	SerializeHordeRawArray(Ar, Snapshot.Targets);
+	return Ar;
+}
+
+// writes the snapshot to the file in one block
+bool	FSphereHordeSnapshot::SaveToFile(const FString& FilePath)
+{
+	return SaveHordeBinaryFile(FilePath, SphereHordeSnapshotFormat, *this, 64 + Targets.Num() * sizeof(FSphereTargetRecord));
+}
+
+// reads the snapshot from the file, returns false if the file is missing or is not a valid snapshot
+bool	FSphereHordeSnapshot::LoadFromFile(const FString& FilePath)
+{
+	return LoadHordeBinaryFile(FilePath, SphereHordeSnapshotFormat, *this);
+}
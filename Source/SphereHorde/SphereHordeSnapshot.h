@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SphereTarget.h"
+
+/*
+	define the binary snapshot of the horde, it is written and read with FArchive in one block
+
+	1. wave number and number of the destroyed spheres
+	2. spawn rules of the current wave and the spawner position
+	3. flat array of the live targets, position, scale, wave and shell
+*/
+
+// the packed state of a live target, the array of the records is serialized as a raw memory block
+struct FSphereTargetRecord
+{
+	// position of the target
+	FVector	Location;
+
+	// uniform scale of the target
+	float	Scale;
+
+	// the id of the wave the target was spawned in
+	int32	WaveId;
+
+	// the shell the target was spawned into
+	ESphereTargetShell	Shell;
+
+	uint8	Padding[3];
+
+	FSphereTargetRecord()
+		: Location(FVector::ZeroVector)
+		, Scale(1.f)
+		, WaveId(0)
+		, Shell(ESphereTargetShell::Outer)
+		, Padding{ 0, 0, 0 }
+	{
+	}
+};
+
+// the spawn rules of the current wave, everything else is either in the spawner defaults or in the wave schedule
+struct FSphereHordeSpawnerState
+{
+	// the id of the current wave
+	int32	WaveId = 1;
+
+	// number of actor to spawn per wave
+	int32	ActorsNb = 0;
+
+	// number of actors to spawn in inner radius
+	int32	InnerRadiusActorsNb = 0;
+
+	// radius of the inner and outter spawn area
+	float	InnerSpawnRadius = 0.f;
+	float	OutterSpawnRadius = 0.f;
+
+	// the spawner position, the origin of the current wave
+	FVector	Origin = FVector::ZeroVector;
+
+	friend FArchive& operator<<(FArchive& Ar, FSphereHordeSpawnerState& State);
+};
+
+// the snapshot of the whole horde
+struct FSphereHordeSnapshot
+{
+	// the number of the current wave
+	int32	CurrentWaveNumber = 1;
+
+	// the number of the destroyed spheres
+	int32	DestroyedSpheres = 0;
+
+	// the spawn rules of the current wave
+	FSphereHordeSpawnerState	SpawnerState;
+
+	// the live targets
+	TArray<FSphereTargetRecord>	Targets;
+
+	friend FArchive& operator<<(FArchive& Ar, FSphereHordeSnapshot& Snapshot);
+
+	// writes the snapshot to the file in one block
+	bool	SaveToFile(const FString& FilePath);
+
+	// reads the snapshot from the file, returns false if the file is missing or is not a valid snapshot
+	bool	LoadFromFile(const FString& FilePath);
+};
@@ -0,0 +1,261 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SphereHordeTargetIndex.h"
+#include "SphereHordeDormantTargets.h"
+#include "SphereHordeLatticeCache.h"
+#include "SphereHordeMovingHorde.h"
+
+/*
+	the policies the spawn loop of the spawner is composed of, they are picked at compile time by the spawner presets,
+	so the chosen combination is inlined into the loop and no virtual call is made per attempt
+
+	1. samplers pick the candidate locations, Sample returns false once the sampler has no locations left
+	2. validators accept or reject the candidate locations
+	3. scalers pick the scale of each placed target
+*/
+
+// the state of the spawner the policies read, built once per spawn call, the fields a caller does not set stay empty
+struct FSphereHordeSpawnContext
+{
+	// the spawn origin and the pawn the horde is spawned around
+	FVector	Origin = FVector::ZeroVector;
+	FVector	PawnLocation = FVector::ZeroVector;
+
+	// the box the locations are sampled in and the radius around the origin they must be within
+	FVector	BoxExtent = FVector::ZeroVector;
+	float	Radius = 0.f;
+
+	// the minimum distance between the targets, and between the targets and the pawn
+	float	DistanceBetweenObjects = 0.f;
+
+	// the range of the target scale and the step of the stepped scale
+	float	MinActorScale = 1.f;
+	float	MaxActorScale = 1.f;
+	float	ScaleActorStep = 0.f;
+
+	// the placed targets, the hidden targets of the prepared wave included
+	const FSphereHordeTargetIndex*	TargetIndex = nullptr;
+
+	// the targets far from the pawn that have no actors, nullptr if the targets are not streamed
+	const FSphereHordeDormantTargets*	DormantTargets = nullptr;
+
+	// the targets handed over to the moving horde, they are not in the index anymore, nullptr if the horde does not move
+	const ASphereHordeMovingHorde*	MovingHorde = nullptr;
+
+	// the precomputed point sets of the spawn radii, nullptr if the spawner does not build them
+	const FSphereHordeLatticeCache*	LatticeCache = nullptr;
+
+	// the stream the random values are picked from, so the replays place the same targets
+	FRandomStream*	Stream = nullptr;
+};
+
+// uniform random points in the spawn box, the points outside the radius are rejected by the validator
+struct FBoxSpawnSampler
+{
+	explicit FBoxSpawnSampler(const FSphereHordeSpawnContext& Context)
+	{
+	}
+
+	FORCEINLINE bool	Sample(const FSphereHordeSpawnContext& Context, FVector& OutLocation)
+	{
+		const FVector& Origin = Context.Origin;
+		const FVector& BoxExtent = Context.BoxExtent;
+		OutLocation = FVector(
+			Context.Stream->FRandRange(Origin.X - BoxExtent.X, Origin.X + BoxExtent.X),
+			Context.Stream->FRandRange(Origin.Y - BoxExtent.Y, Origin.Y + BoxExtent.Y),
+			Context.Stream->FRandRange(Origin.Z - BoxExtent.Z, Origin.Z + BoxExtent.Z));
+		return true;
+	}
+};
+
+// uniform random points in the disc of the radius around the origin, the height is picked within the box,
+// no point lands outside the radius, so there are less rejected attempts than with the box sampler
+struct FDiscSpawnSampler
+{
+	explicit FDiscSpawnSampler(const FSphereHordeSpawnContext& Context)
+		// the points exactly on the radius are rejected by the validator
+		: SampleRadius(FMath::Min(Context.Radius * 0.999f, Context.BoxExtent.Size2D()))
+	{
+	}
+
+	FORCEINLINE bool	Sample(const FSphereHordeSpawnContext& Context, FVector& OutLocation)
+	{
+		// the square root of the uniform value spreads the points evenly over the area of the disc
+		const float PointRadius = SampleRadius * FMath::Sqrt(Context.Stream->GetFraction());
+		const float PointAngle = Context.Stream->FRandRange(0.f, 2.f * PI);
+		float SinAngle, CosAngle;
+		FMath::SinCos(&SinAngle, &CosAngle, PointAngle);
+
+		OutLocation = FVector(
+			Context.Origin.X + PointRadius * CosAngle,
+			Context.Origin.Y + PointRadius * SinAngle,
+			Context.Stream->FRandRange(Context.Origin.Z - Context.BoxExtent.Z, Context.Origin.Z + Context.BoxExtent.Z));
+		return true;
+	}
+
+private:
+	float	SampleRadius;
+};
+
+// the points of the precomputed shell of the radius, rotated by a random angle and moved to the origin,
+// the points are visited in a random order, each of them once, so a wave takes about as many attempts as it has targets,
+// the box sampler is used if there is no shell for the radius, and once all the points of the shell are visited,
+// so the waves larger than their shell are still placed whole
+struct FLatticeSpawnSampler
+{
+	explicit FLatticeSpawnSampler(const FSphereHordeSpawnContext& Context)
+		: Shell(Context.LatticeCache ? Context.LatticeCache->FindShell(Context.Radius) : nullptr)
+		, BoxSampler(Context)
+		, PointsNb(Shell ? Shell->Num() : 0)
+		, NextPointId(0)
+		, PointsStride(1)
+		, VisitedPointsNb(0)
+		, SinAngle(0.f)
+		, CosAngle(1.f)
+	{
+		if (PointsNb > 0)
+		{
+			FMath::SinCos(&SinAngle, &CosAngle, Context.Stream->FRandRange(0.f, 2.f * PI));
+
+			// the stride coprime with the number of the points visits all of them before coming back to the first one
+			NextPointId = Context.Stream->RandRange(0, PointsNb - 1);
+			PointsStride = Context.Stream->RandRange(1, PointsNb);
+			while (GreatestCommonDivisor(PointsStride, PointsNb) != 1)
+			{
+				PointsStride++;
+			}
+		}
+	}
+
+	FORCEINLINE bool	Sample(const FSphereHordeSpawnContext& Context, FVector& OutLocation)
+	{
+		if (!Shell || VisitedPointsNb >= PointsNb)
+		{
+			return BoxSampler.Sample(Context, OutLocation);
+		}
+
+		const FVector2D Point = Shell->GetPoint(NextPointId);
+		NextPointId = (NextPointId + PointsStride) % PointsNb;
+		VisitedPointsNb++;
+
+		OutLocation = FVector(
+			Context.Origin.X + Point.X * CosAngle - Point.Y * SinAngle,
+			Context.Origin.Y + Point.X * SinAngle + Point.Y * CosAngle,
+			Context.Stream->FRandRange(Context.Origin.Z - Context.BoxExtent.Z, Context.Origin.Z + Context.BoxExtent.Z));
+		return true;
+	}
+
+private:
+	const FSphereHordeLatticeShell*	Shell;
+	FBoxSpawnSampler	BoxSampler;
+	int32	PointsNb;
+	int32	NextPointId;
+	int32	PointsStride;
+	int32	VisitedPointsNb;
+	float	SinAngle;
+	float	CosAngle;
+
+	static int32	GreatestCommonDivisor(int32 A, int32 B)
+	{
+		while (B != 0)
+		{
+			const int32 Remainder = A % B;
+			A = B;
+			B = Remainder;
+		}
+		return A;
+	}
+};
+
+// the cached reachable points on the navmesh, visited in a random order, each of them once
+struct FNavPointsSpawnSampler
+{
+	FNavPointsSpawnSampler(TArray<FVector>& InPoints, float InHeightOffset)
+		: Points(InPoints)
+		, HeightOffset(0.f, 0.f, InHeightOffset)
+		, NextPointId(0)
+	{
+	}
+
+	FORCEINLINE bool	Sample(const FSphereHordeSpawnContext& Context, FVector& OutLocation)
+	{
+		if (NextPointId >= Points.Num())
+		{
+			return false;
+		}
+
+		Points.Swap(NextPointId, Context.Stream->RandRange(NextPointId, Points.Num() - 1));
+		OutLocation = Points[NextPointId++] + HeightOffset;
+		return true;
+	}
+
+private:
+	TArray<FVector>&	Points;
+	FVector				HeightOffset;
+	int32				NextPointId;
+};
+
+// accepts the locations inside the radius, far enough from the pawn and from the placed targets
+struct FSpacingSpawnValidator
+{
+	static FORCEINLINE bool	IsValid(const FSphereHordeSpawnContext& Context, const FVector& Location)
+	{
+		// compare squared distances, there is no need in the square root for the comparison
+		if (FVector::DistSquared(Location, Context.PawnLocation) <= FMath::Square(Context.DistanceBetweenObjects))
+		{
+			return false;
+		}
+		if (FVector::DistSquared(Location, Context.Origin) >= FMath::Square(Context.Radius))
+		{
+			return false;
+		}
+
+		// check the distance to the placed targets through the spatial index, to the dormant targets and to the moving targets
+		return !Context.TargetIndex->IsAnyCenterWithin(Location, Context.DistanceBetweenObjects)
+			&& !(Context.DormantTargets && Context.DormantTargets->IsAnyCenterWithin(Location, Context.DistanceBetweenObjects))
+			&& !(Context.MovingHorde && Context.MovingHorde->IsAnyTargetWithin(Location, Context.DistanceBetweenObjects));
+	}
+};
+
+// accepts the locations inside the radius and far enough from the pawn, the targets may overlap each other,
+// the pooled targets are moved to the locations without any collision check, so the dense presets place them inside each other
+struct FRadiusSpawnValidator
+{
+	static FORCEINLINE bool	IsValid(const FSphereHordeSpawnContext& Context, const FVector& Location)
+	{
+		return FVector::DistSquared(Location, Context.PawnLocation) > FMath::Square(Context.DistanceBetweenObjects)
+			&& FVector::DistSquared(Location, Context.Origin) < FMath::Square(Context.Radius);
+	}
+};
+
+// each next target of the wave is smaller by the scale step, down to the minimum scale
+struct FSteppedSpawnScaler
+{
+	static FORCEINLINE float	NextScale(const FSphereHordeSpawnContext& Context, float& CurrentScale)
+	{
+		const float Scale = CurrentScale;
+		CurrentScale = FMath::Clamp(CurrentScale - Context.ScaleActorStep, Context.MinActorScale, Context.MaxActorScale);
+		return Scale;
+	}
+};
+
+// all the targets have the maximum scale
+struct FConstantSpawnScaler
+{
+	static FORCEINLINE float	NextScale(const FSphereHordeSpawnContext& Context, float& CurrentScale)
+	{
+		return Context.MaxActorScale;
+	}
+};
+
+// the scale of each target is picked uniformly between the minimum and the maximum scale
+struct FRandomSpawnScaler
+{
+	static FORCEINLINE float	NextScale(const FSphereHordeSpawnContext& Context, float& CurrentScale)
+	{
+		return Context.Stream->FRandRange(Context.MinActorScale, Context.MaxActorScale);
+	}
+};
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeSpawnerPresets.h"
+#include "Misc/Paths.h"
+
+// places the targets at the points in the disc, kept apart from each other with the stepped scale
+int32	ADiscRadialActorsSpawner::SpawnTargetSpheresInArea(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden)
+{
+	return SpawnTargetSpheresWithPolicies<FDiscSpawnSampler, FSpacingSpawnValidator, FSteppedSpawnScaler>(SpawnClass, NbOfSpheres, BoxExtent, Radius, WaveId, bSpawnHidden);
+}
+
+// places the targets at the points in the box, kept apart from each other with the random scale
+int32	ARandomScaleRadialActorsSpawner::SpawnTargetSpheresInArea(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden)
+{
+	return SpawnTargetSpheresWithPolicies<FBoxSpawnSampler, FSpacingSpawnValidator, FRandomSpawnScaler>(SpawnClass, NbOfSpheres, BoxExtent, Radius, WaveId, bSpawnHidden);
+}
+
+// places the targets at the points in the disc, without keeping them apart from each other, with the constant scale
+int32	ADenseRadialActorsSpawner::SpawnTargetSpheresInArea(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden)
+{
+	return SpawnTargetSpheresWithPolicies<FDiscSpawnSampler, FRadiusSpawnValidator, FConstantSpawnScaler>(SpawnClass, NbOfSpheres, BoxExtent, Radius, WaveId, bSpawnHidden);
+}
+
+// loads the point sets of the spawn radii, or builds and saves them
+void	ALatticeRadialActorsSpawner::PrepareSpawnPolicies()
+{
+	Super::PrepareSpawnPolicies();
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<float> SpawnRadii;
+	GetWaveSpawnRadii(LatticeWavesNb, SpawnRadii);
+
+	const FString LatticePath = FPaths::ProjectSavedDir() / TEXT("HordeLattice") / (GetClass()->GetName() + TEXT(".hordelattice"));
+	if (LatticeCache.LoadFromFile(LatticePath) && LatticeCache.Matches(SpawnRadii, SpawnRules.DistanceBetweenObjects, MaxLatticePointsPerShell))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Loaded %d lattice shells from %s in %.2f ms"), LatticeCache.Num(), *LatticePath, (FPlatformTime::Seconds() - StartTime) * 1000.0)
+		return;
+	}
+
+	LatticeCache.Build(SpawnRadii, SpawnRules.DistanceBetweenObjects, MaxLatticePointsPerShell);
+	if (!LatticeCache.SaveToFile(LatticePath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FAILED to write the lattice cache %s"), *LatticePath)
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Built %d lattice shells in %.2f ms"), LatticeCache.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0)
+}
+
+// get the precomputed point sets of the spawn radii
+const FSphereHordeLatticeCache*	ALatticeRadialActorsSpawner::GetLatticeCache() const
+{
+	return &LatticeCache;
+}
+
+// places the targets at the precomputed points of the spawn radius, kept apart from each other with the stepped scale
+int32	ALatticeRadialActorsSpawner::SpawnTargetSpheresInArea(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden)
+{
+	return SpawnTargetSpheresWithPolicies<FLatticeSpawnSampler, FSpacingSpawnValidator, FSteppedSpawnScaler>(SpawnClass, NbOfSpheres, BoxExtent, Radius, WaveId, bSpawnHidden);
+}
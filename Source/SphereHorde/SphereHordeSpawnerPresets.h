@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RadialActorsSpawner.h"
+#include "SphereHordeSpawnerPresets.generated.h"
+
+/*
+	the spawners with the other combinations of the spawn policies, set one of them as the spheres spawner of the game mode
+	to compare the strategies, each of them compiles its own spawn loop, so there is no cost of the abstraction per attempt
+
+	1. disc spawner: the points in the disc of the radius, the targets kept apart, the stepped scale
+	2. random scale spawner: the points in the box, the targets kept apart, the random scale
+	3. dense spawner: the points in the disc, the targets may be close to each other, the constant scale
+	4. lattice spawner: the precomputed points of the spawn radius, the targets kept apart, the stepped scale
+*/
+
+UCLASS()
+class SPHEREHORDE_API ADiscRadialActorsSpawner : public ARadialActorsSpawner
+{
+	GENERATED_BODY()
+
+protected:
+	// places the targets at the points in the disc, kept apart from each other with the stepped scale
+	virtual int32	SpawnTargetSpheresInArea(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden) override;
+};
+
+UCLASS()
+class SPHEREHORDE_API ARandomScaleRadialActorsSpawner : public ARadialActorsSpawner
+{
+	GENERATED_BODY()
+
+protected:
+	// places the targets at the points in the box, kept apart from each other with the random scale
+	virtual int32	SpawnTargetSpheresInArea(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden) override;
+};
+
+UCLASS()
+class SPHEREHORDE_API ADenseRadialActorsSpawner : public ARadialActorsSpawner
+{
+	GENERATED_BODY()
+
+protected:
+	// places the targets at the points in the disc, without keeping them apart from each other, with the constant scale
+	virtual int32	SpawnTargetSpheresInArea(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden) override;
+};
+
+UCLASS()
+class SPHEREHORDE_API ALatticeRadialActorsSpawner : public ARadialActorsSpawner
+{
+	GENERATED_BODY()
+
+protected:
+	// the number of the waves the point sets are precomputed for, the later waves are placed with the random points in the box
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "1", ClampMax = "200", UIMin = "1", UIMax = "200"), Category = "Lattice")
+	int32	LatticeWavesNb = 30;
+
+	// the max number of the points of a spawn radius, the points are at least DistanceBetweenObjects apart
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "16", ClampMax = "65536", UIMin = "16", UIMax = "65536"), Category = "Lattice")
+	int32	MaxLatticePointsPerShell = 4096;
+
+	// loads the point sets of the spawn radii from Saved/HordeLattice, or builds and saves them if the file is missing or is built for other rules
+	virtual void	PrepareSpawnPolicies() override;
+
+	// get the precomputed point sets of the spawn radii
+	virtual const FSphereHordeLatticeCache*	GetLatticeCache() const override;
+
+	// places the targets at the precomputed points of the spawn radius, kept apart from each other with the stepped scale
+	virtual int32	SpawnTargetSpheresInArea(UClass* SpawnClass, int32 NbOfSpheres, const FVector& BoxExtent, float Radius, int32 WaveId, bool bSpawnHidden) override;
+
+private:
+	// the point sets of the spawn radii
+	FSphereHordeLatticeCache	LatticeCache;
+};
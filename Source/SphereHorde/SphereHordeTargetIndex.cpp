@@ -0,0 +1,400 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeTargetIndex.h"
+#include "SphereTarget.h"
+#include "Components/SceneComponent.h"
+
+FSphereHordeTargetIndex::FSphereHordeTargetIndex()
+{
+	TargetsNb = 0;
+	TargetsBounds.Init();
+	CellSize = 500.f;
+	QueryStamp = 0;
+}
+
+// sets the size of the cells, drops all the targets
+void	FSphereHordeTargetIndex::Initialize(float InCellSize)
+{
+	Reset();
+	CellSize = FMath::Max(InCellSize, 1.f);
+}
+
+// adds the target with its current bounds
+FSphereTargetHandle	FSphereHordeTargetIndex::Add(ASphereTarget* Target)
+{
+	if (!Target)
+	{
+		return FSphereTargetHandle();
+	}
+
+	// the target is moved to its new bounds if it is indexed already
+	Remove(Target);
+
+	const int32 SlotIndex = (FreeSlots.Num() > 0) ? FreeSlots.Pop(false) : Slots.AddDefaulted();
+	FTargetSlot& TargetSlot = Slots[SlotIndex];
+
+	const FBoxSphereBounds Bounds = Target->GetRootComponent() ? Target->GetRootComponent()->Bounds : FBoxSphereBounds(Target->GetActorLocation(), FVector::ZeroVector, 0.f);
+	TargetSlot.Target = Target;
+	TargetSlot.Center = Bounds.Origin;
+	TargetSlot.Radius = Bounds.SphereRadius;
+	TargetSlot.MinCell = GetCell(Bounds.Origin - FVector(Bounds.SphereRadius));
+	TargetSlot.MaxCell = GetCell(Bounds.Origin + FVector(Bounds.SphereRadius));
+	TargetSlot.Serial++;
+	TargetsBounds += Bounds.GetBox();
+
+	for (int32 Z = TargetSlot.MinCell.Z; Z <= TargetSlot.MaxCell.Z; Z++)
+	{
+		for (int32 Y = TargetSlot.MinCell.Y; Y <= TargetSlot.MaxCell.Y; Y++)
+		{
+			for (int32 X = TargetSlot.MinCell.X; X <= TargetSlot.MaxCell.X; X++)
+			{
+				Cells.FindOrAdd(FIntVector(X, Y, Z)).Add(SlotIndex);
+			}
+		}
+	}
+
+	Target->SetIndexSlot(SlotIndex);
+	TargetsNb++;
+
+	FSphereTargetHandle Handle;
+	Handle.Slot = SlotIndex;
+	Handle.Serial = TargetSlot.Serial;
+	return Handle;
+}
+
+// removes the target from the index
+void	FSphereHordeTargetIndex::Remove(ASphereTarget* Target)
+{
+	const int32 SlotIndex = Target ? Target->GetIndexSlot() : INDEX_NONE;
+	if (!Slots.IsValidIndex(SlotIndex) || Slots[SlotIndex].Target != Target)
+	{
+		return;
+	}
+
+	FTargetSlot& TargetSlot = Slots[SlotIndex];
+	for (int32 Z = TargetSlot.MinCell.Z; Z <= TargetSlot.MaxCell.Z; Z++)
+	{
+		for (int32 Y = TargetSlot.MinCell.Y; Y <= TargetSlot.MaxCell.Y; Y++)
+		{
+			for (int32 X = TargetSlot.MinCell.X; X <= TargetSlot.MaxCell.X; X++)
+			{
+				const FIntVector Cell(X, Y, Z);
+				if (TArray<int32>* CellSlots = Cells.Find(Cell))
+				{
+					CellSlots->RemoveSingleSwap(SlotIndex, false);
+					if (CellSlots->Num() == 0)
+					{
+						Cells.Remove(Cell);
+					}
+				}
+			}
+		}
+	}
+
+	TargetSlot.Target = nullptr;
+	TargetSlot.Serial++;
+	FreeSlots.Add(SlotIndex);
+	Target->SetIndexSlot(INDEX_NONE);
+	TargetsNb--;
+}
+
+// removes all the targets, the slots are kept with their serials, so the handles taken before the reset stay stale
+void	FSphereHordeTargetIndex::Reset()
+{
+	FreeSlots.Reset(Slots.Num());
+	for (int32 SlotIndex = Slots.Num() - 1; SlotIndex >= 0; SlotIndex--)
+	{
+		FTargetSlot& TargetSlot = Slots[SlotIndex];
+		if (TargetSlot.Target)
+		{
+			TargetSlot.Target->SetIndexSlot(INDEX_NONE);
+			TargetSlot.Target = nullptr;
+			TargetSlot.Serial++;
+		}
+		FreeSlots.Add(SlotIndex);
+	}
+
+	Cells.Reset();
+	TargetsNb = 0;
+	TargetsBounds.Init();
+}
+
+// get the target by its handle, nullptr if the handle is stale
+ASphereTarget*	FSphereHordeTargetIndex::Resolve(const FSphereTargetHandle& Handle) const
+{
+	if (!Slots.IsValidIndex(Handle.Slot) || Slots[Handle.Slot].Serial != Handle.Serial)
+	{
+		return nullptr;
+	}
+	return Slots[Handle.Slot].Target;
+}
+
+// get the number of the indexed targets
+int32	FSphereHordeTargetIndex::Num() const
+{
+	return TargetsNb;
+}
+
+// get the cell the point is in
+FIntVector	FSphereHordeTargetIndex::GetCell(const FVector& Point) const
+{
+	return FIntVector(FMath::FloorToInt(Point.X / CellSize), FMath::FloorToInt(Point.Y / CellSize), FMath::FloorToInt(Point.Z / CellSize));
+}
+
+// starts a new query
+uint32	FSphereHordeTargetIndex::BeginQuery() const
+{
+	// the stamps of all the slots are cleared once the counter wraps around
+	if (++QueryStamp == 0)
+	{
+		for (const FTargetSlot& TargetSlot : Slots)
+		{
+			TargetSlot.QueryStamp = 0;
+		}
+		QueryStamp = 1;
+	}
+	return QueryStamp;
+}
+
+// checks if the slot can be returned by the queries
+bool	FSphereHordeTargetIndex::IsSlotVisible(const FTargetSlot& TargetSlot) const
+{
+	return TargetSlot.Target && TargetSlot.Target->IsTargetEnabled();
+}
+
+// visits each slot listed in the cells of the box once, the occupied cells are walked instead if there are less of them than in the box
+template <typename VisitorType>
+void	FSphereHordeTargetIndex::ForEachSlotInBox(const FVector& BoxMin, const FVector& BoxMax, VisitorType Visitor) const
+{
+	const uint32 Stamp = BeginQuery();
+	auto VisitCell = [this, Stamp, &Visitor](const TArray<int32>& CellSlots)
+	{
+		for (const int32 SlotIndex : CellSlots)
+		{
+			const FTargetSlot& TargetSlot = Slots[SlotIndex];
+			if (TargetSlot.QueryStamp != Stamp)
+			{
+				TargetSlot.QueryStamp = Stamp;
+				if (!Visitor(SlotIndex, TargetSlot))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	const FIntVector MinCell = GetCell(BoxMin);
+	const FIntVector MaxCell = GetCell(BoxMax);
+	const int64 BoxCellsNb = (int64)(MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1) * (MaxCell.Z - MinCell.Z + 1);
+
+	if (BoxCellsNb > Cells.Num())
+	{
+		for (const TPair<FIntVector, TArray<int32>>& Cell : Cells)
+		{
+			const FIntVector& CellCoords = Cell.Key;
+			if (CellCoords.X >= MinCell.X && CellCoords.X <= MaxCell.X && CellCoords.Y >= MinCell.Y && CellCoords.Y <= MaxCell.Y
+				&& CellCoords.Z >= MinCell.Z && CellCoords.Z <= MaxCell.Z && !VisitCell(Cell.Value))
+			{
+				return;
+			}
+		}
+		return;
+	}
+
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+			{
+				const TArray<int32>* CellSlots = Cells.Find(FIntVector(X, Y, Z));
+				if (CellSlots && !VisitCell(*CellSlots))
+				{
+					return;
+				}
+			}
+		}
+	}
+}
+
+// collects the targets whose bounds overlap the sphere
+void	FSphereHordeTargetIndex::QueryRadius(const FVector& Center, float Radius, FSphereTargetHandleArray& OutHandles, bool bIncludeHidden) const
+{
+	ForEachSlotInBox(Center - FVector(Radius), Center + FVector(Radius), [this, &Center, Radius, &OutHandles, bIncludeHidden](int32 SlotIndex, const FTargetSlot& TargetSlot)
+	{
+		if ((bIncludeHidden || IsSlotVisible(TargetSlot)) && FVector::DistSquared(Center, TargetSlot.Center) <= FMath::Square(Radius + TargetSlot.Radius))
+		{
+			FSphereTargetHandle Handle;
+			Handle.Slot = SlotIndex;
+			Handle.Serial = TargetSlot.Serial;
+			OutHandles.Add(Handle);
+		}
+		return true;
+	});
+}
+
+// checks if any target, the hidden ones included, has its center closer than the distance to the location
+bool	FSphereHordeTargetIndex::IsAnyCenterWithin(const FVector& Location, float Distance) const
+{
+	// the cell of the center of the target is always among the cells it is listed in
+	bool bIsFound = false;
+	ForEachSlotInBox(Location - FVector(Distance), Location + FVector(Distance), [&Location, Distance, &bIsFound](int32 SlotIndex, const FTargetSlot& TargetSlot)
+	{
+		bIsFound = FVector::DistSquared(Location, TargetSlot.Center) <= FMath::Square(Distance);
+		return !bIsFound;
+	});
+	return bIsFound;
+}
+
+// collects up to K targets closest to the point, the search box grows until the K-th target is closer than its border
+void	FSphereHordeTargetIndex::QueryNearest(const FVector& Point, int32 K, TArray<FSphereTargetHandle>& OutHandles, TFunctionRef<bool(const ASphereTarget*)> Filter) const
+{
+	if (K <= 0 || TargetsNb == 0)
+	{
+		return;
+	}
+
+	struct FNearestCandidate
+	{
+		int32	Slot;
+		float	DistanceSquared;
+	};
+	TArray<FNearestCandidate, TInlineAllocator<64>> Candidates;
+
+	for (float SearchRadius = CellSize; ; SearchRadius *= 2.f)
+	{
+		Candidates.Reset();
+		ForEachSlotInBox(Point - FVector(SearchRadius), Point + FVector(SearchRadius), [this, &Point, &Candidates, &Filter](int32 SlotIndex, const FTargetSlot& TargetSlot)
+		{
+			if (IsSlotVisible(TargetSlot) && Filter(TargetSlot.Target))
+			{
+				Candidates.Add({ SlotIndex, FVector::DistSquared(Point, TargetSlot.Center) });
+			}
+			return true;
+		});
+
+		Candidates.Sort([](const FNearestCandidate& A, const FNearestCandidate& B) { return A.DistanceSquared < B.DistanceSquared; });
+
+		// the targets with the centers outside the box are farther than its half size, the candidates closer than it are final
+		const FBox SearchBox(Point - FVector(SearchRadius), Point + FVector(SearchRadius));
+		const bool bIsWholeIndexSearched = !TargetsBounds.IsValid || SearchBox.IsInside(TargetsBounds);
+		const bool bHasEnoughCloseCandidates = (Candidates.Num() >= K && Candidates[K - 1].DistanceSquared <= FMath::Square(SearchRadius));
+		if (bHasEnoughCloseCandidates || bIsWholeIndexSearched)
+		{
+			break;
+		}
+	}
+
+	const int32 FoundNb = FMath::Min(K, Candidates.Num());
+	for (int32 i = 0; i < FoundNb; i++)
+	{
+		FSphereTargetHandle Handle;
+		Handle.Slot = Candidates[i].Slot;
+		Handle.Serial = Slots[Candidates[i].Slot].Serial;
+		OutHandles.Add(Handle);
+	}
+}
+
+// collects up to MaxHitsNb targets the ray hits within the distance, the nearest hit first, the cells are walked in the order the ray crosses them
+void	FSphereHordeTargetIndex::QueryRay(const FVector& Start, const FVector& Direction, float MaxDistance, FSphereTargetHandleArray& OutHandles, int32 MaxHitsNb) const
+{
+	const FVector RayDirection = Direction.GetSafeNormal();
+	if (RayDirection.IsZero() || TargetsNb == 0 || MaxHitsNb <= 0)
+	{
+		return;
+	}
+
+	// the walk through the cells, the distances along the ray to the next cell border on each axis and between the borders
+	FIntVector Cell = GetCell(Start);
+	const FIntVector EndCell = GetCell(Start + RayDirection * MaxDistance);
+	FIntVector Step;
+	FVector NextBorderDistance;
+	FVector BorderDistanceStep;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		const float AxisDirection = RayDirection[Axis];
+		Step[Axis] = (AxisDirection > 0.f) ? 1 : ((AxisDirection < 0.f) ? -1 : 0);
+		if (Step[Axis] == 0)
+		{
+			NextBorderDistance[Axis] = MAX_flt;
+			BorderDistanceStep[Axis] = MAX_flt;
+			continue;
+		}
+
+		const float NextBorder = (Cell[Axis] + (Step[Axis] > 0 ? 1 : 0)) * CellSize;
+		NextBorderDistance[Axis] = (NextBorder - Start[Axis]) / AxisDirection;
+		BorderDistanceStep[Axis] = CellSize / FMath::Abs(AxisDirection);
+	}
+
+	// the hits found so far, kept ordered by the distance and cut to the number asked for
+	struct FRayHit
+	{
+		int32	Slot;
+		float	HitDistance;
+	};
+	TArray<FRayHit, TInlineAllocator<64>> Hits;
+
+	const uint32 Stamp = BeginQuery();
+	const int32 MaxCellsNb = FMath::Abs(EndCell.X - Cell.X) + FMath::Abs(EndCell.Y - Cell.Y) + FMath::Abs(EndCell.Z - Cell.Z) + 1;
+	for (int32 VisitedCellsNb = 0; VisitedCellsNb < MaxCellsNb; VisitedCellsNb++)
+	{
+		if (const TArray<int32>* CellSlots = Cells.Find(Cell))
+		{
+			for (const int32 SlotIndex : *CellSlots)
+			{
+				const FTargetSlot& TargetSlot = Slots[SlotIndex];
+				if (TargetSlot.QueryStamp == Stamp || !IsSlotVisible(TargetSlot))
+				{
+					continue;
+				}
+				TargetSlot.QueryStamp = Stamp;
+
+				// the ray and sphere intersection, the nearest root in front of the start
+				const FVector ToCenter = TargetSlot.Center - Start;
+				const float Projection = FVector::DotProduct(ToCenter, RayDirection);
+				const float DiscriminantSquared = FMath::Square(TargetSlot.Radius) - (ToCenter.SizeSquared() - FMath::Square(Projection));
+				if (DiscriminantSquared < 0.f || Projection + FMath::Sqrt(DiscriminantSquared) < 0.f)
+				{
+					continue;
+				}
+
+				const float HitDistance = FMath::Max(Projection - FMath::Sqrt(DiscriminantSquared), 0.f);
+				if (HitDistance > MaxDistance || (Hits.Num() == MaxHitsNb && HitDistance >= Hits.Last().HitDistance))
+				{
+					continue;
+				}
+
+				int32 HitIndex = Hits.Num();
+				while (HitIndex > 0 && Hits[HitIndex - 1].HitDistance > HitDistance)
+				{
+					HitIndex--;
+				}
+				Hits.Insert({ SlotIndex, HitDistance }, HitIndex);
+				if (Hits.Num() > MaxHitsNb)
+				{
+					Hits.Pop(false);
+				}
+			}
+		}
+
+		// the hits in the next cells are farther than the border of this one
+		const float CellExitDistance = FMath::Min3(NextBorderDistance.X, NextBorderDistance.Y, NextBorderDistance.Z);
+		if (Hits.Num() == MaxHitsNb && Hits.Last().HitDistance <= CellExitDistance)
+		{
+			break;
+		}
+
+		const int32 Axis = (NextBorderDistance.X <= NextBorderDistance.Y && NextBorderDistance.X <= NextBorderDistance.Z) ? 0 : ((NextBorderDistance.Y <= NextBorderDistance.Z) ? 1 : 2);
+		Cell[Axis] += Step[Axis];
+		NextBorderDistance[Axis] += BorderDistanceStep[Axis];
+	}
+
+	for (const FRayHit& Hit : Hits)
+	{
+		FSphereTargetHandle Handle;
+		Handle.Slot = Hit.Slot;
+		Handle.Serial = Slots[Hit.Slot].Serial;
+		OutHandles.Add(Handle);
+	}
+}
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ASphereTarget;
+
+/*
+	define the spatial index over the placed targets, a uniform grid of cells over the bounding spheres of the targets,
+	each target is listed in every cell its bounds overlap, the targets are added and removed one by one as they are placed and killed
+
+	1. radius query, the targets whose bounds overlap the sphere
+	2. k-nearest query, the targets closest to the point
+	3. ray query, the targets along the ray ordered by the hit distance, the cells are walked in the order the ray crosses them
+
+	the queries do not touch the physics scene and return the handles of the targets, the hidden targets
+	of the prepared wave are indexed too and are skipped by the queries unless they are asked for
+*/
+
+// the handle of an indexed target, it gets stale when the target is removed from the index
+struct FSphereTargetHandle
+{
+	// the slot of the target in the index
+	int32	Slot = INDEX_NONE;
+
+	// the serial of the slot, it changes each time the slot is reused or the index is reset
+	uint32	Serial = 0;
+
+	bool	IsValid() const { return Slot != INDEX_NONE; }
+};
+
+// the handles found by a radius query, a query finds few targets, so they are kept on the stack
+typedef TArray<FSphereTargetHandle, TInlineAllocator<64>>	FSphereTargetHandleArray;
+
+class FSphereHordeTargetIndex
+{
+public:
+	FSphereHordeTargetIndex();
+
+	// sets the size of the cells, drops all the targets
+	void	Initialize(float InCellSize);
+
+	// adds the target with its current bounds, the target keeps the slot to be removed by it
+	FSphereTargetHandle	Add(ASphereTarget* Target);
+
+	// removes the target from the index, does nothing if it is not indexed
+	void	Remove(ASphereTarget* Target);
+
+	// removes all the targets
+	void	Reset();
+
+	// get the target by its handle, nullptr if the handle is stale
+	ASphereTarget*	Resolve(const FSphereTargetHandle& Handle) const;
+
+	// get the number of the indexed targets
+	int32	Num() const;
+
+	// collects the targets whose bounds overlap the sphere
+	void	QueryRadius(const FVector& Center, float Radius, FSphereTargetHandleArray& OutHandles, bool bIncludeHidden = false) const;
+
+	// checks if any target, the hidden ones included, has its center closer than the distance to the location
+	bool	IsAnyCenterWithin(const FVector& Location, float Distance) const;
+
+	// collects up to K targets closest to the point, the closest first, the optional filter skips the targets it returns false for
+	void	QueryNearest(const FVector& Point, int32 K, TArray<FSphereTargetHandle>& OutHandles, TFunctionRef<bool(const ASphereTarget*)> Filter = [](const ASphereTarget*) { return true; }) const;
+
+	// collects up to MaxHitsNb targets the ray hits within the distance, the nearest hit first
+	void	QueryRay(const FVector& Start, const FVector& Direction, float MaxDistance, FSphereTargetHandleArray& OutHandles, int32 MaxHitsNb = MAX_int32) const;
+
+private:
+	// the bounds of an indexed target and the cells it is listed in
+	struct FTargetSlot
+	{
+		ASphereTarget*	Target = nullptr;
+		FVector		Center = FVector::ZeroVector;
+		float		Radius = 0.f;
+		FIntVector	MinCell = FIntVector::ZeroValue;
+		FIntVector	MaxCell = FIntVector::ZeroValue;
+		uint32		Serial = 0;
+
+		// the number of the query that visited the slot last, a target listed in several cells is tested once per query
+		mutable uint32	QueryStamp = 0;
+	};
+
+	TArray<FTargetSlot>	Slots;
+	TArray<int32>		FreeSlots;
+	int32				TargetsNb;
+
+	// the box around all the targets added since the last reset, it only grows, the nearest query stops once it covers it
+	FBox				TargetsBounds;
+
+	// the slots listed in each non-empty cell
+	TMap<FIntVector, TArray<int32>>	Cells;
+
+	// the size of a cell, in world units
+	float	CellSize;
+
+	// the number of the current query
+	mutable uint32	QueryStamp;
+
+	// get the cell the point is in
+	FIntVector	GetCell(const FVector& Point) const;
+
+	// starts a new query, the slots visited by the previous ones are not skipped anymore
+	uint32	BeginQuery() const;
+
+	// visits each slot listed in the cells of the box once, stops when the visitor returns false
+	template <typename VisitorType>
+	void	ForEachSlotInBox(const FVector& BoxMin, const FVector& BoxMax, VisitorType Visitor) const;
+
+	// checks if the slot can be returned by the queries
+	bool	IsSlotVisible(const FTargetSlot& TargetSlot) const;
+};
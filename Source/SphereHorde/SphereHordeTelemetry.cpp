@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereHordeTelemetry.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Paths.h"
+#include "Misc/Compression.h"
+#include "SphereHordeBinaryFile.h"
+
+// the binary file starts with the magic number 'SHTL', the version and the record size, then the compressed blocks follow,
+// each block is its uncompressed size, its compressed size and the compressed records
+static const FSphereHordeBinaryFormat	SphereHordeTelemetryFormat = { 0x4C544853, 1 };
+
+// the capacity of the ring buffer, the writer drains it several times a second
+static const uint32	SphereHordeTelemetryCapacity = 16384;
+
+// the time the writer thread sleeps between the flushes, in milliseconds
+static const uint32	SphereHordeTelemetryFlushIntervalMs = 250;
+
+// the names of the events in the json lines
+static const TCHAR* GetTelemetryEventName(ESphereHordeTelemetryEvent Type)
+{
+	switch (Type)
+	{
+	case ESphereHordeTelemetryEvent::Kill:				return TEXT("kill");
+	case ESphereHordeTelemetryEvent::WaveStart:			return TEXT("wave_start");
+	case ESphereHordeTelemetryEvent::WaveEnd:			return TEXT("wave_end");
+	case ESphereHordeTelemetryEvent::WaveSpawn:			return TEXT("wave_spawn");
+	case ESphereHordeTelemetryEvent::PlacementFailure:	return TEXT("placement_failure");
+	case ESphereHordeTelemetryEvent::Shot:				return TEXT("shot");
+	default:											return TEXT("unknown");
+	}
+}
+
+// opens the file for appending and starts the writer thread
+FSphereHordeTelemetry::FSphereHordeTelemetry(const FString& InFilePath, ESphereHordeTelemetryFormat InFormat)
+	: Events(SphereHordeTelemetryCapacity)
+	, DroppedEventsNb(0)
+	, FilePath(InFilePath)
+	, Format(InFormat)
+	, Thread(nullptr)
+	, WakeUpEvent(nullptr)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+
+	const bool bIsNewFile = !PlatformFile.FileExists(*FilePath);
+	FileHandle.Reset(PlatformFile.OpenWrite(*FilePath, true));
+	if (!FileHandle)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FAILED to open the telemetry file %s"), *FilePath)
+		return;
+	}
+
+	if (bIsNewFile && Format == ESphereHordeTelemetryFormat::Binary)
+	{
+		TArray<uint8> Header;
+		FMemoryWriter Writer(Header);
+		SerializeHordeBinaryHeader(Writer, SphereHordeTelemetryFormat);
+		int32 RecordSize = sizeof(FSphereHordeTelemetryRecord);
+		Writer << RecordSize;
+		FileHandle->Write(Header.GetData(), Header.Num());
+	}
+
+	PendingRecords.Reserve(SphereHordeTelemetryCapacity);
+	WakeUpEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("SphereHordeTelemetry"), 0, TPri_BelowNormal);
+}
+
+// stops the writer thread, the events left in the ring buffer are written before the file is closed
+FSphereHordeTelemetry::~FSphereHordeTelemetry()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if (WakeUpEvent)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeUpEvent);
+		WakeUpEvent = nullptr;
+	}
+
+	if (DroppedEventsNb > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%d telemetry events were dropped, the ring buffer was full"), DroppedEventsNb)
+	}
+}
+
+// pushes the event to the ring buffer, it never waits for the writer thread
+void	FSphereHordeTelemetry::Record(ESphereHordeTelemetryEvent Type, double Time, const FVector& Location, int32 WaveId, float Value)
+{
+	if (!Thread)
+	{
+		return;
+	}
+
+	FSphereHordeTelemetryRecord TelemetryRecord;
+	TelemetryRecord.Time = Time;
+	TelemetryRecord.Location = Location;
+	TelemetryRecord.Value = Value;
+	TelemetryRecord.WaveId = WaveId;
+	TelemetryRecord.Type = Type;
+
+	if (!Events.Enqueue(TelemetryRecord))
+	{
+		DroppedEventsNb++;
+	}
+}
+
+// get the path of the telemetry file
+const FString&	FSphereHordeTelemetry::GetFilePath() const
+{
+	return FilePath;
+}
+
+// the writer thread appends the events until it is stopped, then writes what is left
+uint32	FSphereHordeTelemetry::Run()
+{
+	while (!bIsStopping)
+	{
+		WakeUpEvent->Wait(SphereHordeTelemetryFlushIntervalMs);
+		WriteEvents();
+	}
+
+	WriteEvents();
+	FileHandle.Reset();
+	return 0;
+}
+
+void	FSphereHordeTelemetry::Stop()
+{
+	bIsStopping = true;
+	WakeUpEvent->Trigger();
+}
+
+// drains the ring buffer and appends the events to the file
+void	FSphereHordeTelemetry::WriteEvents()
+{
+	PendingRecords.Reset();
+	FSphereHordeTelemetryRecord TelemetryRecord;
+	while (Events.Dequeue(TelemetryRecord))
+	{
+		PendingRecords.Add(TelemetryRecord);
+	}
+
+	if (PendingRecords.Num() == 0 || !FileHandle)
+	{
+		return;
+	}
+
+	if (Format == ESphereHordeTelemetryFormat::Json)
+	{
+		WriteJson();
+	}
+	else
+	{
+		WriteBinary();
+	}
+	FileHandle->Flush();
+}
+
+// appends the events as json lines
+void	FSphereHordeTelemetry::WriteJson()
+{
+	WriteBuffer.Reset();
+	for (const FSphereHordeTelemetryRecord& TelemetryRecord : PendingRecords)
+	{
+		const FString Line = FString::Printf(TEXT("{\"t\":%.4f,\"e\":\"%s\",\"wave\":%d,\"x\":%.1f,\"y\":%.1f,\"z\":%.1f,\"v\":%.3f}\n"),
+			TelemetryRecord.Time, GetTelemetryEventName(TelemetryRecord.Type), TelemetryRecord.WaveId,
+			TelemetryRecord.Location.X, TelemetryRecord.Location.Y, TelemetryRecord.Location.Z, TelemetryRecord.Value);
+
+		const FTCHARToUTF8 Utf8Line(*Line);
+		WriteBuffer.Append(reinterpret_cast<const uint8*>(Utf8Line.Get()), Utf8Line.Length());
+	}
+
+	FileHandle->Write(WriteBuffer.GetData(), WriteBuffer.Num());
+}
+
+// appends the events as one compressed block
+void	FSphereHordeTelemetry::WriteBinary()
+{
+	const int32 UncompressedSize = PendingRecords.Num() * sizeof(FSphereHordeTelemetryRecord);
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedSize);
+	CompressedBuffer.SetNumUninitialized(CompressedSize, false);
+
+	if (!FCompression::CompressMemory(NAME_Zlib, CompressedBuffer.GetData(), CompressedSize, PendingRecords.GetData(), UncompressedSize))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FAILED to compress %d telemetry events"), PendingRecords.Num())
+		return;
+	}
+
+	const int32 BlockHeader[2] = { UncompressedSize, CompressedSize };
+	FileHandle->Write(reinterpret_cast<const uint8*>(BlockHeader), sizeof(BlockHeader));
+	FileHandle->Write(CompressedBuffer.GetData(), CompressedSize);
+}
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Containers/CircularQueue.h"
+
+class FRunnableThread;
+class FEvent;
+class IFileHandle;
+
+/*
+	define the telemetry recorder, the game thread pushes the events to the lock-free ring buffer
+	and the background thread drains it and appends the events to the file
+
+	1. kills with the position, the wave start and end, the wave spawn durations
+	2. placement failures and the shots fired
+	3. newline-delimited json or the zlib compressed blocks of the binary records
+*/
+
+// the type of the telemetry event
+enum class ESphereHordeTelemetryEvent : uint8
+{
+	// a target is destroyed, the value is 1 for the in range targets
+	Kill,
+	// a wave is started, the value is the number of the destroyed spheres
+	WaveStart,
+	// a wave is finished, the value is the number of the destroyed spheres
+	WaveEnd,
+	// a wave is spawned, the value is the game thread time it took, in milliseconds
+	WaveSpawn,
+	// the spawner could not place targets, the value is the number of the targets it could not place
+	PlacementFailure,
+	// a projectile is fired
+	Shot,
+};
+
+// the format of the telemetry file
+enum class ESphereHordeTelemetryFormat : uint8
+{
+	// one json object per line
+	Json,
+	// the zlib compressed blocks of the raw records
+	Binary,
+};
+
+// the telemetry event, the records are written to the binary file as raw memory blocks
+struct FSphereHordeTelemetryRecord
+{
+	// the game time of the event, in seconds
+	double	Time;
+
+	// the position of the event
+	FVector	Location;
+
+	// the value of the event, its meaning depends on the type
+	float	Value;
+
+	// the wave the event belongs to
+	int32	WaveId;
+
+	// the type of the event
+	ESphereHordeTelemetryEvent	Type;
+
+	uint8	Padding[3];
+
+	FSphereHordeTelemetryRecord()
+		: Time(0.0)
+		, Location(FVector::ZeroVector)
+		, Value(0.f)
+		, WaveId(0)
+		, Type(ESphereHordeTelemetryEvent::Kill)
+		, Padding{ 0, 0, 0 }
+	{
+	}
+};
+
+class FSphereHordeTelemetry : public FRunnable
+{
+public:
+	// opens the file for appending and starts the writer thread
+	FSphereHordeTelemetry(const FString& InFilePath, ESphereHordeTelemetryFormat InFormat);
+
+	// stops the writer thread, the events left in the ring buffer are written before the file is closed
+	virtual ~FSphereHordeTelemetry();
+
+	// pushes the event to the ring buffer, called on the game thread only, the event is dropped if the buffer is full
+	void	Record(ESphereHordeTelemetryEvent Type, double Time, const FVector& Location, int32 WaveId, float Value);
+
+	// get the path of the telemetry file
+	const FString&	GetFilePath() const;
+
+	// FRunnable interface
+	virtual uint32	Run() override;
+	virtual void	Stop() override;
+
+private:
+	// the single producer single consumer ring buffer, the game thread writes and the writer thread reads
+	TCircularQueue<FSphereHordeTelemetryRecord>	Events;
+
+	// the number of the events dropped because the ring buffer was full
+	int32	DroppedEventsNb;
+
+	// the file the events are appended to, accessed by the writer thread only
+	FString	FilePath;
+	ESphereHordeTelemetryFormat	Format;
+	TUniquePtr<IFileHandle>	FileHandle;
+
+	// the writer thread wakes up on the event or after the flush interval
+	FRunnableThread*	Thread;
+	FEvent*	WakeUpEvent;
+	FThreadSafeBool	bIsStopping;
+
+	// the drained events and the buffers reused by the writer thread
+	TArray<FSphereHordeTelemetryRecord>	PendingRecords;
+	TArray<uint8>	WriteBuffer;
+	TArray<uint8>	CompressedBuffer;
+
+	// drains the ring buffer and appends the events to the file
+	void	WriteEvents();
+
+	// appends the events as json lines or as one compressed block
+	void	WriteJson();
+	void	WriteBinary();
+};
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "SphereHordeWaveSchedule.generated.h"
+
+class ASphereTarget;
+
+/*
+	define the row of the wave schedule table, the table lists the waves in order,
+	the row N describes the wave N, the last row is used for all the waves after it
+
+	1. number of actors to spawn and number of them in the inner radius
+	2. inner and outter spawn radius
+	3. range and step of the actors scale
+	4. type of actors to spawn
+	5. number of actors placed per frame while the wave is prepared
+*/
+
+USTRUCT(BlueprintType)
+struct FSphereHordeWaveScheduleRow : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	// number of actor to spawn in the wave
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1"))
+	int32	ActorsNb = 15;
+
+	// number of actors to spawn in inner radius
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	int32	InnerRadiusActorsNb = 10;
+
+	// radius of the aread where to spawn the inner actors
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.0"))
+	float	InnerSpawnRadius = 1500.f;
+
+	// radius of the aread where to spawn the outter actors
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.0"))
+	float	OutterSpawnRadius = 2000.f;
+
+	// minimum scale of the actor to spawn
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.01"))
+	float	MinActorScale = 0.5f;
+
+	// maximum scale of the actor to spawn, the first actor of the wave gets it
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.01"))
+	float	MaxActorScale = 1.f;
+
+	// the step of decreasing the scale of the spawned actors
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.0"))
+	float	ScaleActorStep = 0.1f;
+
+	// type of actors to spawn, the spawner defaults are used if it is not set
+	UPROPERTY(EditAnywhere)
+	TSoftClassPtr<ASphereTarget>	SpawnObject;
+
+	// the number of the actors placed per frame while the wave is prepared in the background
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1"))
+	int32	PreparedActorsPerTick = 10;
+};
@@ -25,24 +25,111 @@ ASphereTarget::ASphereTarget()
 	Mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh Component"));
 	Mesh->SetupAttachment(CollisionCapsule);
 	Mesh->SetCollisionProfileName("Pawn");
+
+	// the target is not tagged until the spawner places it
+	WaveId = 0;
+	Shell = ESphereTargetShell::Outer;
+
+	// the target actors are not replicated, the clients get them through the replicated horde
+	bReplicates = false;
+	NetTargetId = INDEX_NONE;
+	IndexSlot = INDEX_NONE;
+
+	bIsTargetEnabled = true;
 }
 
 void ASphereTarget::PlayDeathEffectsAndDestroy()
 {
-	// play destruction vfx if the DestructionParticle particle system is not nullptr
-	if (DestructionParticle)
+	ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+
+	PlayDeathEffects();
+
+	// the game mode returns the target to the spawner pool, the target is destroyed only if there is no game mode
+	if (GameMode)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), DestructionParticle, GetActorLocation());
+		GameMode->UpdatedNubmerOfDestroyedSpheres(this);
+	}
+	else
+	{
+		Destroy();
 	}
+}
 
+// spawn the destruction vfx from the pool of the world
+void	ASphereTarget::PlayDeathEffects()
+{
 	ASphereHordeGameMode* GameMode = Cast<ASphereHordeGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
-	Destroy();
-	if (GameMode)
+
+	// play destruction vfx if the DestructionParticle particle system is loaded,
+	// it is never loaded here synchronously to avoid the hitch on the kill, and it is skipped when the game is over its frame budget
+	UParticleSystem* LoadedDestructionParticle = DestructionParticle.Get();
+	if (LoadedDestructionParticle && (!GameMode || GameMode->ShouldPlayDestructionVfx()))
 	{
-		GameMode->UpdatedNubmerOfDestroyedSpheres(this);
+		// the finished emitters are returned to the pool of the world instead of being destroyed
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), LoadedDestructionParticle, GetActorLocation(), FRotator::ZeroRotator, FVector(1.f), true, EPSCPoolMethod::AutoRelease);
 	}
 }
 
+// tags the target with the wave it was spawned in and the shell it landed in
+void	ASphereTarget::SetSpawnInfo(int32 InWaveId, ESphereTargetShell InShell)
+{
+	WaveId = InWaveId;
+	Shell = InShell;
+}
+
+// get the id of the wave the target was spawned in
+int32	ASphereTarget::GetWaveId() const
+{
+	return WaveId;
+}
+
+// get the shell the target was spawned into
+ESphereTargetShell	ASphereTarget::GetShell() const
+{
+	return Shell;
+}
+
+// checks if the target counts towards the wave progress when destroyed
+bool	ASphereTarget::IsInRange() const
+{
+	return Shell == ESphereTargetShell::Inner;
+}
+
+// shows the target and enables its collision, the disabled targets are hidden and can not be hit
+void	ASphereTarget::SetTargetEnabled(bool bEnabled)
+{
+	bIsTargetEnabled = bEnabled;
+	SetActorHiddenInGame(!bEnabled);
+	SetActorEnableCollision(bEnabled);
+}
+
+// checks if the target is shown and can be hit
+bool	ASphereTarget::IsTargetEnabled() const
+{
+	return bIsTargetEnabled;
+}
+
+// collects the softly referenced assets that should be loaded before the target is spawned
+void	ASphereTarget::GetAssetsToPreload(TArray<FSoftObjectPath>& OutAssets) const
+{
+	if (!DestructionParticle.IsNull())
+	{
+		OutAssets.Add(DestructionParticle.ToSoftObjectPath());
+	}
+}
+
+// sets the id of the target in the replicated horde
+void	ASphereTarget::SetNetTargetId(int32 InNetTargetId)
+{
+	NetTargetId = InNetTargetId;
+}
+
+// get the id of the target in the replicated horde
+int32	ASphereTarget::GetNetTargetId() const
+{
+	return NetTargetId;
+}
+
 // Called when the game starts or when spawned
 void ASphereTarget::BeginPlay()
 {
@@ -55,3 +142,14 @@ void ASphereTarget::Tick(float DeltaTime)
 	Super::Tick(DeltaTime);
 }
 
+// set the slot of the target in the spatial index of the spawner
+void	ASphereTarget::SetIndexSlot(int32 InIndexSlot)
+{
+	IndexSlot = InIndexSlot;
+}
+
+// get the slot of the target in the spatial index of the spawner
+int32	ASphereTarget::GetIndexSlot() const
+{
+	return IndexSlot;
+}
@@ -10,6 +10,26 @@ class UStaticMeshComponent;
 class UCapsuleComponent;
 class UParticleSystem;
 
+// the shell the target was spawned into, relative to the in-range radius of the spawn origin
+// only the targets of the inner shell are counted towards the wave progress
+UENUM()
+enum class ESphereTargetShell : uint8
+{
+	Inner,
+	Outer
+};
+
+// the tags and the location of a destroyed target, the kills of a blast are counted in one batch
+struct FSphereTargetKill
+{
+	FVector				Location;
+	int32				WaveId;
+	ESphereTargetShell	Shell;
+};
+
+// the kills of one blast, a blast catches few targets, so they are kept on the stack
+typedef TArray<FSphereTargetKill, TInlineAllocator<64>>	FSphereTargetKillArray;
+
 UCLASS()
 class SPHEREHORDE_API ASphereTarget : public AActor
 {
@@ -36,8 +56,8 @@ protected:
 	float CollisionSphereRadius = 50.f;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Vfx")
-	// particle system component for the vfx when the object is destroyed
-	UParticleSystem*	DestructionParticle;
+	// particle system for the vfx when the object is destroyed, it is loaded asynchronously by the spawner
+	TSoftObjectPtr<UParticleSystem>	DestructionParticle;
 
 public:	
 	// Called every frame
@@ -45,4 +65,56 @@ public:
 
 	// destroy the object an spawn vfx
 	void	PlayDeathEffectsAndDestroy();
+
+	// spawn the destruction vfx from the pool of the world, it is skipped if the vfx is not loaded or the game is over its frame budget
+	void	PlayDeathEffects();
+
+	// tags the target with the wave it was spawned in and the shell it landed in
+	void	SetSpawnInfo(int32 InWaveId, ESphereTargetShell InShell);
+
+	// get the id of the wave the target was spawned in
+	int32	GetWaveId() const;
+
+	// get the shell the target was spawned into
+	ESphereTargetShell	GetShell() const;
+
+	// checks if the target counts towards the wave progress when destroyed
+	bool	IsInRange() const;
+
+	// shows the target and enables its collision, the disabled targets are hidden and can not be hit
+	void	SetTargetEnabled(bool bEnabled);
+
+	// checks if the target is shown and can be hit
+	bool	IsTargetEnabled() const;
+
+	// collects the softly referenced assets that should be loaded before the target is spawned
+	void	GetAssetsToPreload(TArray<FSoftObjectPath>& OutAssets) const;
+
+	// sets the id of the target in the replicated horde, INDEX_NONE if the target is not replicated
+	void	SetNetTargetId(int32 InNetTargetId);
+
+	// get the id of the target in the replicated horde
+	int32	GetNetTargetId() const;
+
+	// set the slot of the target in the spatial index of the spawner, INDEX_NONE if it is not indexed
+	void	SetIndexSlot(int32 InIndexSlot);
+
+	// get the slot of the target in the spatial index of the spawner
+	int32	GetIndexSlot() const;
+
+private:
+	// the id of the wave the target was spawned in
+	int32	WaveId;
+
+	// the shell the target was spawned into
+	ESphereTargetShell	Shell;
+
+	// the id of the target in the replicated horde
+	int32	NetTargetId;
+
+	// the slot of the target in the spatial index of the spawner
+	int32	IndexSlot;
+
+	// true if the target is shown and can be hit
+	bool	bIsTargetEnabled;
 };